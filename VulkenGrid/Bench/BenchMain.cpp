@@ -0,0 +1,490 @@
+// VulkanGridBench: scripted headless scenarios with machine-readable results.
+//
+//   VulkanGridBench [--scenario=all|draws|pipelines|upload|recording|grid-kernels] [--frames=N]
+//                   [--size=WxH] [--draws=N] [--pipelines=N] [--upload-mb=N]
+//                   [--record-items=N] [--grid-cells=N] [--output=results.json]
+//
+// Run from the build output directory so shaders/ resolves. Needs no window or
+// GPU; under CI use a CPU driver, e.g. VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json.
+// JSON goes to stdout (or --output); logging stays in logs/.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "VulkanInstance.h"
+#include "VulkanDevice.h"
+#include "VulkanBuffer.h"
+#include "OffscreenTarget.h"
+#include "UploadManager.h"
+#include "JobSystem.h"
+#include "FrameStats.h"
+#include "RenderPass.h"
+#include "PipeLine.h"
+#include "PipelineLibrary.h"
+#include "ParallelCommandRecorder.h"
+#include "GpuProfiler.h"
+#include "GridSoA.h"
+#include "Logger.h"
+
+namespace {
+
+struct BenchOptions {
+    std::string scenario = "all";
+    uint32_t frameCount = 300;
+    VkExtent2D extent{ 256, 256 };     // Small so CPU drivers are not fill-rate bound
+    uint32_t drawCount = 10000;        // vkCmdDraw calls per frame in "draws"
+    uint32_t pipelineCount = 64;       // Distinct pipelines compiled in "pipelines"
+    uint32_t uploadMegabytes = 256;    // Bytes pushed through UploadManager in "upload"
+    uint32_t recordItems = 100000;     // Draws recorded per iteration in "recording"
+    uint32_t gridCells = 10000000;     // Cells updated per pass in "grid-kernels"
+    std::string outputPath;            // stdout when empty
+};
+
+struct ScenarioResult {
+    std::string name;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+// Everything the scenarios share: one headless device rendering the triangle pipeline offscreen.
+struct BenchContext {
+    VulkanDevice& device;
+    OffscreenTarget& target;
+    RenderPass& renderPass;
+    Pipeline& pipeline;
+    JobSystem& jobSystem;
+    uint32_t framesInFlight;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+BenchOptions parseBenchOptions(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--scenario=", 0) == 0) {
+            options.scenario = arg.substr(11);
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            options.frameCount = static_cast<uint32_t>(std::stoul(arg.substr(9)));
+        } else if (arg.rfind("--size=", 0) == 0) {
+            const std::string size = arg.substr(7);
+            size_t separator = size.find('x');
+            if (separator != std::string::npos) {
+                options.extent.width = static_cast<uint32_t>(std::stoul(size.substr(0, separator)));
+                options.extent.height = static_cast<uint32_t>(std::stoul(size.substr(separator + 1)));
+            }
+        } else if (arg.rfind("--draws=", 0) == 0) {
+            options.drawCount = static_cast<uint32_t>(std::stoul(arg.substr(8)));
+        } else if (arg.rfind("--pipelines=", 0) == 0) {
+            options.pipelineCount = static_cast<uint32_t>(std::stoul(arg.substr(12)));
+        } else if (arg.rfind("--upload-mb=", 0) == 0) {
+            options.uploadMegabytes = static_cast<uint32_t>(std::stoul(arg.substr(12)));
+        } else if (arg.rfind("--record-items=", 0) == 0) {
+            options.recordItems = static_cast<uint32_t>(std::stoul(arg.substr(15)));
+        } else if (arg.rfind("--grid-cells=", 0) == 0) {
+            options.gridCells = static_cast<uint32_t>(std::stoul(arg.substr(13)));
+        } else if (arg.rfind("--output=", 0) == 0) {
+            options.outputPath = arg.substr(9);
+        } else {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+// Draws frameCount frames and reports throughput plus CPU and GPU frame-time percentiles; returns frames per second.
+double runFrames(BenchContext& context, uint32_t frameCount, ScenarioResult& result) {
+    FrameStats frameStats;
+    GpuProfiler gpuProfiler(context.device, context.framesInFlight);
+    gpuProfiler.init();
+    gpuProfiler.setReportInterval(0);
+    gpuProfiler.setFrameTimeCallback([&frameStats](double ms) { frameStats.record(FrameMetric::GpuTime, ms); });
+
+    // Warm up caches, lazily recorded command buffers and driver state outside the measurement.
+    for (uint32_t i = 0; i < context.framesInFlight + 1; i++) {
+        context.renderPass.drawFrame(&context.pipeline);
+    }
+    context.renderPass.getFrameRing().waitIdle();
+    // Attached only now: warm-up timestamps would be read back during the measured loop.
+    context.renderPass.setGpuProfiler(&gpuProfiler);
+
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < frameCount; i++) {
+        auto frameStart = Clock::now();
+        context.renderPass.drawFrame(&context.pipeline);
+        frameStats.record(FrameMetric::CpuTime, std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+    }
+    context.renderPass.getFrameRing().waitIdle();
+    double seconds = secondsSince(start);
+
+    // The last frames' GPU results are only read when their slots are reused.
+    context.renderPass.setGpuProfiler(nullptr);
+    gpuProfiler.cleanup();
+
+    FrameStatsSummary cpu = frameStats.getSummary(FrameMetric::CpuTime);
+    FrameStatsSummary gpu = frameStats.getSummary(FrameMetric::GpuTime);
+    double fps = seconds > 0.0 ? frameCount / seconds : 0.0;
+    result.metrics.push_back({ "frames", frameCount });
+    result.metrics.push_back({ "fps", fps });
+    result.metrics.push_back({ "cpu_ms_p50", cpu.p50Ms });
+    result.metrics.push_back({ "cpu_ms_p95", cpu.p95Ms });
+    result.metrics.push_back({ "cpu_ms_p99", cpu.p99Ms });
+    result.metrics.push_back({ "cpu_ms_max", cpu.maxMs });
+    result.metrics.push_back({ "gpu_ms_p50", gpu.p50Ms });
+    result.metrics.push_back({ "gpu_ms_p99", gpu.p99Ms });
+    return fps;
+}
+
+// N draws per frame through the RenderPass draw list, recorded on the job system every frame.
+ScenarioResult runDrawsScenario(BenchContext& context, const BenchOptions& options) {
+    ScenarioResult result{ "draws", {} };
+    context.renderPass.setJobSystem(&context.jobSystem);
+
+    Pipeline& pipeline = context.pipeline;
+    RenderPass& renderPass = context.renderPass;
+    RecordRangeCallback recordDraws = [&pipeline, &renderPass](VkCommandBuffer commandBuffer, size_t begin, size_t end) {
+        pipeline.bind(commandBuffer);
+        renderPass.setViewportAndScissor(commandBuffer);
+        for (size_t i = begin; i < end; i++) {
+            vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        }
+    };
+    size_t drawCount = options.drawCount;
+    context.renderPass.setDrawListCallbacks([drawCount](FrameContext&) { return drawCount; }, recordDraws);
+
+    double fps = runFrames(context, options.frameCount, result);
+    result.metrics.push_back({ "draws_per_frame", options.drawCount });
+    result.metrics.push_back({ "draws_per_second", fps * options.drawCount });
+
+    context.renderPass.setDrawListCallbacks(nullptr, nullptr);
+    context.renderPass.setJobSystem(nullptr);
+    return result;
+}
+
+// Variant i of the triangle pipeline; every index below the variant count gives distinct state.
+GraphicsPipelineDesc pipelineVariant(uint32_t index, VkPipelineLayout layout, VkRenderPass renderPass) {
+    static const VkPrimitiveTopology topologies[] = { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+                                                      VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN };
+    static const VkCullModeFlags cullModes[] = { VK_CULL_MODE_NONE, VK_CULL_MODE_FRONT_BIT, VK_CULL_MODE_BACK_BIT,
+                                                 VK_CULL_MODE_FRONT_AND_BACK };
+
+    GraphicsPipelineDesc desc;
+    desc.shaders = {
+        { VK_SHADER_STAGE_VERTEX_BIT, "shaders/triangle.vert.spv" },
+        { VK_SHADER_STAGE_FRAGMENT_BIT, "shaders/triangle.frag.spv" }
+    };
+    desc.topology = topologies[index % 3];
+    index /= 3;
+    desc.cullMode = cullModes[index % 4];
+    index /= 4;
+    desc.frontFace = index % 2 ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+    index /= 2;
+    desc.blendEnable = index % 2 != 0;
+    index /= 2;
+    desc.colorWriteMask = 15 - index % 15; // Never 0
+    desc.layout = layout;
+    desc.renderPass = renderPass;
+    return desc;
+}
+
+constexpr uint32_t kPipelineVariantCount = 3 * 4 * 2 * 2 * 15;
+
+// Cold compiles through PipelineLibrary (no pipeline cache), then the deduplicated lookup path.
+ScenarioResult runPipelinesScenario(BenchContext& context, const BenchOptions& options) {
+    ScenarioResult result{ "pipelines", {} };
+    uint32_t count = std::min(options.pipelineCount, kPipelineVariantCount);
+    if (count < options.pipelineCount) {
+        VG_LOG_WARN("Only ", kPipelineVariantCount, " pipeline variants exist; compiling ", count);
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    VkPipelineLayout layout;
+    if (vkCreatePipelineLayout(context.device.getDevice(), &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create benchmark pipeline layout.");
+        throw std::runtime_error("Failed to create benchmark pipeline layout!");
+    }
+
+    std::vector<GraphicsPipelineDesc> descs;
+    for (uint32_t i = 0; i < count; i++) {
+        descs.push_back(pipelineVariant(i, layout, context.renderPass.getRenderPass()));
+    }
+
+    PipelineLibrary library(context.device);
+    library.init();
+
+    auto start = Clock::now();
+    std::vector<PipelineHandle> handles;
+    for (const auto& desc : descs) {
+        handles.push_back(library.request(desc));
+    }
+    uint32_t failed = 0;
+    for (const auto& handle : handles) {
+        if (handle.get() == VK_NULL_HANDLE) {
+            failed++;
+        }
+    }
+    double compileSeconds = secondsSince(start);
+
+    start = Clock::now();
+    for (const auto& desc : descs) {
+        library.request(desc);
+    }
+    double lookupSeconds = secondsSince(start);
+
+    result.metrics.push_back({ "pipelines", count });
+    result.metrics.push_back({ "failed", failed });
+    result.metrics.push_back({ "compile_ms_total", compileSeconds * 1000.0 });
+    result.metrics.push_back({ "compile_ms_per_pipeline", count ? compileSeconds * 1000.0 / count : 0.0 });
+    result.metrics.push_back({ "lookup_us_per_request", count ? lookupSeconds * 1e6 / count : 0.0 });
+
+    library.cleanup();
+    vkDestroyPipelineLayout(context.device.getDevice(), layout, nullptr);
+    return result;
+}
+
+// Pushes uploadMegabytes through staging into a device-local buffer and waits for the transfer queue.
+ScenarioResult runUploadScenario(BenchContext& context, const BenchOptions& options) {
+    ScenarioResult result{ "upload", {} };
+    constexpr VkDeviceSize kBlockSize = 4ull * 1024 * 1024;
+    constexpr VkDeviceSize kDestinationSize = 64ull * 1024 * 1024;
+
+    VulkanBuffer destination(context.device);
+    destination.createBuffer(kDestinationSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             MemoryUsage::GpuOnly);
+    std::vector<uint8_t> block(kBlockSize);
+    for (size_t i = 0; i < block.size(); i++) {
+        block[i] = static_cast<uint8_t>(i * 31);
+    }
+
+    UploadManager uploadManager(context.device);
+    uploadManager.init();
+
+    VkDeviceSize total = static_cast<VkDeviceSize>(options.uploadMegabytes) * 1024 * 1024;
+    VkDeviceSize offset = 0;
+    uint64_t lastValue = 0;
+    auto start = Clock::now();
+    for (VkDeviceSize sent = 0; sent < total; sent += kBlockSize) {
+        VkDeviceSize size = std::min(kBlockSize, total - sent);
+        uploadManager.uploadBuffer(destination.getBuffer(), offset, block.data(), size);
+        offset = (offset + size) % kDestinationSize;
+        // One flush per block, as a frame streaming this much data would do.
+        lastValue = uploadManager.flush();
+    }
+    uploadManager.wait(lastValue);
+    double seconds = secondsSince(start);
+
+    result.metrics.push_back({ "megabytes", options.uploadMegabytes });
+    result.metrics.push_back({ "seconds", seconds });
+    result.metrics.push_back({ "megabytes_per_second", seconds > 0.0 ? options.uploadMegabytes / seconds : 0.0 });
+    result.metrics.push_back({ "dedicated_transfer_queue", context.device.hasDedicatedTransferQueue() ? 1.0 : 0.0 });
+
+    uploadManager.cleanup();
+    destination.cleanup();
+    return result;
+}
+
+// CPU-only: records recordItems draws into secondaries on the job system, never submitted.
+ScenarioResult runRecordingScenario(BenchContext& context, const BenchOptions& options) {
+    ScenarioResult result{ "recording", {} };
+    ParallelCommandRecorder recorder(context.device, context.jobSystem, context.framesInFlight);
+    recorder.init();
+
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = context.renderPass.getRenderPass();
+    inheritance.subpass = 0;
+
+    Pipeline& pipeline = context.pipeline;
+    RenderPass& renderPass = context.renderPass;
+    RecordRangeCallback recordDraws = [&pipeline, &renderPass](VkCommandBuffer commandBuffer, size_t begin, size_t end) {
+        pipeline.bind(commandBuffer);
+        renderPass.setViewportAndScissor(commandBuffer);
+        for (size_t i = begin; i < end; i++) {
+            vkCmdDraw(commandBuffer, 3, 1, static_cast<uint32_t>(i % 3), 0);
+        }
+    };
+
+    // Fake frames: nothing is submitted, so each slot's pools may be reset as soon as it comes round again.
+    FrameContext frame;
+    std::vector<VkCommandBuffer> secondaries;
+    uint32_t iterations = std::max(options.frameCount, 1u);
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        frame.index = i % context.framesInFlight;
+        frame.frameNumber = i + 1;
+        secondaries.clear();
+        recorder.record(frame, inheritance, options.recordItems, recordDraws, secondaries);
+    }
+    double seconds = secondsSince(start);
+
+    double draws = static_cast<double>(options.recordItems) * iterations;
+    result.metrics.push_back({ "iterations", iterations });
+    result.metrics.push_back({ "draws_per_iteration", options.recordItems });
+    result.metrics.push_back({ "threads", context.jobSystem.getThreadSlotCount() });
+    result.metrics.push_back({ "ms_per_iteration", seconds * 1000.0 / iterations });
+    result.metrics.push_back({ "draws_per_second", seconds > 0.0 ? draws / seconds : 0.0 });
+
+    recorder.cleanup();
+    return result;
+}
+
+// CPU-only: the same per-cell updates as a loop over GridInstance and as GridSoA kernels at each SIMD level.
+ScenarioResult runGridKernelsScenario(const BenchOptions& options) {
+    ScenarioResult result{ "grid-kernels", {} };
+    const uint32_t width = 1000;
+    const uint32_t height = std::max(options.gridCells / width, 1u);
+    const size_t cellCount = static_cast<size_t>(width) * height;
+    const uint32_t iterations = 10;
+
+    auto timeMs = [iterations](auto&& pass) {
+        pass(); // Warm up: page in and cache what fits
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            pass();
+        }
+        return secondsSince(start) * 1000.0 / iterations;
+    };
+
+    std::vector<GridInstance> cells(cellCount, GridInstance{});
+    result.metrics.push_back({ "cells", static_cast<double>(cellCount) });
+    result.metrics.push_back({ "aos_translate_ms", timeMs([&cells] {
+        for (GridInstance& cell : cells) {
+            cell.x += 0.5f;
+            cell.y += 0.25f;
+        }
+    }) });
+    result.metrics.push_back({ "aos_fade_ms", timeMs([&cells] {
+        for (GridInstance& cell : cells) {
+            cell.color = ((((cell.color & 0x00FF00FFu) * 200) >> 8) & 0x00FF00FFu) | ((((cell.color >> 8) & 0x00FF00FFu) * 200) & 0xFF00FF00u);
+        }
+    }) });
+    result.metrics.push_back({ "aos_state_ms", timeMs([&cells] {
+        for (GridInstance& cell : cells) {
+            cell.state = (cell.state & 0xFFu) | 0x100u;
+        }
+    }) });
+
+    GridSoA grid(width, height);
+    for (GridSimdLevel level : { GridSimdLevel::Scalar, GridSimdLevel::SSE2, GridSimdLevel::AVX2 }) {
+        grid.setSimdLevel(level);
+        if (grid.getSimdLevel() != level) {
+            continue; // Not supported here
+        }
+        const std::string prefix = std::string("soa_") + gridSimdLevelName(level);
+        result.metrics.push_back({ prefix + "_translate_ms", timeMs([&grid] { grid.translate(0.5f, 0.25f); }) });
+        result.metrics.push_back({ prefix + "_fade_ms", timeMs([&grid] { grid.fadeColors(200); }) });
+        result.metrics.push_back({ prefix + "_state_ms", timeMs([&grid] { grid.updateStates(0xFFu, 0x100u); }) });
+        result.metrics.push_back({ prefix + "_pack_ms", timeMs([&grid, &cells, cellCount] { grid.pack(0, cellCount, cells.data()); }) });
+    }
+    return result;
+}
+
+void writeJson(std::ostream& out, const VulkanDevice& device, const BenchOptions& options, const std::vector<ScenarioResult>& results) {
+    char number[64];
+    out << "{\n  \"device\": \"" << device.getProperties().deviceName << "\",\n";
+    out << "  \"extent\": [" << options.extent.width << ", " << options.extent.height << "],\n";
+    out << "  \"scenarios\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << (i ? "," : "") << "\n    { \"name\": \"" << results[i].name << "\", \"metrics\": {";
+        for (size_t j = 0; j < results[i].metrics.size(); j++) {
+            std::snprintf(number, sizeof(number), "%.6g", results[i].metrics[j].second);
+            out << (j ? ", " : " ") << '"' << results[i].metrics[j].first << "\": " << number;
+        }
+        out << " } }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    try {
+        options = parseBenchOptions(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    const bool all = options.scenario == "all";
+    if (!all && options.scenario != "draws" && options.scenario != "pipelines" && options.scenario != "upload" &&
+        options.scenario != "recording" && options.scenario != "grid-kernels") {
+        std::cerr << "Unknown scenario: " << options.scenario << std::endl;
+        return 2;
+    }
+
+    // Validation would dominate the timings being measured.
+    VulkanInstance vulkanInstance;
+    vulkanInstance.headless = true;
+    vulkanInstance.enableValidationLayers = false;
+    VulkanDevice device(vulkanInstance);
+    int exitCode = 0;
+
+    try {
+        vulkanInstance.init();
+        device.init(VK_NULL_HANDLE);
+
+        const uint32_t framesInFlight = FrameContextRing::kDefaultFramesInFlight;
+        OffscreenTarget target(device, options.extent, VK_FORMAT_R8G8B8A8_UNORM, framesInFlight);
+        target.init();
+        RenderPass renderPass(device, target, target.getImageFormat(), framesInFlight);
+        Pipeline pipeline(device, target, renderPass.getRenderPass());
+        pipeline.createGraphicsPipeline();
+        JobSystem jobSystem;
+        jobSystem.init();
+
+        BenchContext context{ device, target, renderPass, pipeline, jobSystem, framesInFlight };
+        std::vector<ScenarioResult> results;
+        if (all || options.scenario == "draws") {
+            results.push_back(runDrawsScenario(context, options));
+        }
+        if (all || options.scenario == "pipelines") {
+            results.push_back(runPipelinesScenario(context, options));
+        }
+        if (all || options.scenario == "upload") {
+            results.push_back(runUploadScenario(context, options));
+        }
+        if (all || options.scenario == "recording") {
+            results.push_back(runRecordingScenario(context, options));
+        }
+        if (all || options.scenario == "grid-kernels") {
+            results.push_back(runGridKernelsScenario(options));
+        }
+
+        if (options.outputPath.empty()) {
+            writeJson(std::cout, device, options, results);
+        } else {
+            std::ofstream file(options.outputPath);
+            writeJson(file, device, options, results);
+            if (!file) {
+                VG_LOG_ERROR("Failed to write ", options.outputPath);
+                exitCode = 1;
+            }
+        }
+
+        jobSystem.cleanup();
+        pipeline.cleanup();
+        renderPass.cleanup();
+        target.cleanup();
+    }
+    catch (const std::exception& e) {
+        VG_LOG_ERROR("Benchmark failed: ", e.what());
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        exitCode = 1;
+    }
+
+    device.cleanup();
+    vulkanInstance.cleanup();
+    return exitCode;
+}
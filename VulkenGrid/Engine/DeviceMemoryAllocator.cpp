@@ -0,0 +1,368 @@
+#include "DeviceMemoryAllocator.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    uint32_t ceilLog2(VkDeviceSize value) {
+        uint32_t order = 0;
+        while ((VkDeviceSize(1) << order) < value) {
+            order++;
+        }
+        return order;
+    }
+
+    uint32_t floorLog2(VkDeviceSize value) {
+        uint32_t order = 0;
+        while ((value >> (order + 1)) != 0) {
+            order++;
+        }
+        return order;
+    }
+}
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator() {
+    cleanup();
+}
+
+void DeviceMemoryAllocator::init(VkDevice logicalDevice, const VkPhysicalDeviceProperties& properties,
+                                 const VkPhysicalDeviceMemoryProperties& deviceMemoryProperties) {
+    device = logicalDevice;
+    memoryProperties = deviceMemoryProperties;
+    nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+    bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+    maxMemoryAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    VG_LOG_INFO("Device memory allocator initialized. Memory types: ", memoryProperties.memoryTypeCount,
+                ", bufferImageGranularity: ", bufferImageGranularity,
+                ", maxMemoryAllocationCount: ", maxMemoryAllocationCount);
+}
+
+void DeviceMemoryAllocator::cleanup() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // Outstanding handles dangle after this, but none of their memory is leaked.
+    if (allocationCount > 0) {
+        VG_LOG_WARN("Device memory allocator destroyed with ", allocationCount, " live allocations (",
+                    allocatedBytes, " bytes, ", dedicatedMemory.size(), " dedicated); freeing them.");
+    }
+    for (const auto& dedicated : dedicatedMemory) {
+        freeDeviceMemory(dedicated.first, dedicated.second != nullptr);
+    }
+    dedicatedMemory.clear();
+    for (auto& block : blocks) {
+        if (block) {
+            freeDeviceMemory(block->memory, block->mappedData != nullptr);
+        }
+    }
+    blocks.clear();
+    deviceMemoryCount = 0;
+    allocationCount = 0;
+    reservedBytes = 0;
+    allocatedBytes = 0;
+    device = VK_NULL_HANDLE;
+    VG_LOG_INFO("Device memory allocator cleaned up.");
+}
+
+bool DeviceMemoryAllocator::isHostVisible(uint32_t memoryTypeIndex) const {
+    return (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+bool DeviceMemoryAllocator::isCoherent(uint32_t memoryTypeIndex) const {
+    return (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+uint32_t DeviceMemoryAllocator::getMinOrder(uint32_t memoryTypeIndex) const {
+    // Non-coherent nodes must cover whole atoms so flushes never touch a neighbour.
+    if (isHostVisible(memoryTypeIndex) && !isCoherent(memoryTypeIndex)) {
+        return std::max(kMinOrder, ceilLog2(nonCoherentAtomSize));
+    }
+    return kMinOrder;
+}
+
+VkDeviceSize DeviceMemoryAllocator::getBlockSize(uint32_t memoryTypeIndex) const {
+    // Small heaps (e.g. the 256 MB BAR window) get proportionally smaller blocks.
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+    VkDeviceSize blockSize = kDefaultBlockSize;
+    while (blockSize > (VkDeviceSize(1) << 20) && blockSize > heapSize / 8) {
+        blockSize >>= 1;
+    }
+    return blockSize;
+}
+
+VkDeviceMemory DeviceMemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData) {
+    if (maxMemoryAllocationCount != 0 && deviceMemoryCount >= maxMemoryAllocationCount) {
+        VG_LOG_ERROR("maxMemoryAllocationCount (", maxMemoryAllocationCount, ") reached.");
+        return VK_NULL_HANDLE;
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+    if (result != VK_SUCCESS) {
+        VG_LOG_WARN("vkAllocateMemory of ", size, " bytes on memory type ", memoryTypeIndex, " failed. VkResult: ", result);
+        return VK_NULL_HANDLE;
+    }
+
+    *mappedData = nullptr;
+    if (isHostVisible(memoryTypeIndex)) {
+        result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mappedData);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to map device memory. VkResult: ", result);
+            vkFreeMemory(device, memory, nullptr);
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    deviceMemoryCount++;
+    reservedBytes += size;
+    return memory;
+}
+
+void DeviceMemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, bool mapped) {
+    if (mapped) {
+        vkUnmapMemory(device, memory);
+    }
+    vkFreeMemory(device, memory, nullptr);
+}
+
+uint32_t DeviceMemoryAllocator::createBlock(uint32_t memoryTypeIndex, AllocationKind kind, uint32_t minimumOrder) {
+    uint32_t minOrder = getMinOrder(memoryTypeIndex);
+    uint32_t maxOrder = floorLog2(getBlockSize(memoryTypeIndex));
+
+    // Halve the block on failure, but never below what the request itself needs.
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    void* mappedData = nullptr;
+    for (; maxOrder >= minimumOrder; maxOrder--) {
+        memory = allocateDeviceMemory(VkDeviceSize(1) << maxOrder, memoryTypeIndex, &mappedData);
+        if (memory != VK_NULL_HANDLE || maxOrder == minimumOrder) {
+            break;
+        }
+    }
+    if (memory == VK_NULL_HANDLE) {
+        return MemoryAllocation::kDedicatedBlock;
+    }
+
+    auto block = std::make_unique<MemoryBlock>();
+    block->memory = memory;
+    block->mappedData = mappedData;
+    block->memoryTypeIndex = memoryTypeIndex;
+    block->kind = kind;
+    block->maxOrder = maxOrder;
+    block->freeBytes = VkDeviceSize(1) << maxOrder;
+    block->freeLists.resize(maxOrder - minOrder + 1);
+    block->freeLists.back().insert(0);
+
+    VG_LOG_DEBUG("Created ", (VkDeviceSize(1) << maxOrder) / (1024 * 1024), " MB memory block on type ", memoryTypeIndex,
+                 kind == AllocationKind::Linear ? " (linear)" : " (optimal)");
+
+    auto slot = std::find(blocks.begin(), blocks.end(), nullptr);
+    if (slot != blocks.end()) {
+        *slot = std::move(block);
+        return static_cast<uint32_t>(slot - blocks.begin());
+    }
+    blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+bool DeviceMemoryAllocator::allocateFromBlock(MemoryBlock& block, uint32_t order, VkDeviceSize& offset) {
+    uint32_t minOrder = block.maxOrder + 1 - static_cast<uint32_t>(block.freeLists.size());
+    if (order > block.maxOrder || block.freeBytes < (VkDeviceSize(1) << order)) {
+        return false;
+    }
+
+    // Smallest free node that fits, split down to the requested order.
+    uint32_t current = order;
+    while (current <= block.maxOrder && block.freeLists[current - minOrder].empty()) {
+        current++;
+    }
+    if (current > block.maxOrder) {
+        return false;
+    }
+
+    auto& freeList = block.freeLists[current - minOrder];
+    offset = *freeList.begin();
+    freeList.erase(freeList.begin());
+    while (current > order) {
+        current--;
+        block.freeLists[current - minOrder].insert(offset + (VkDeviceSize(1) << current));
+    }
+    block.freeBytes -= VkDeviceSize(1) << order;
+    return true;
+}
+
+void DeviceMemoryAllocator::freeToBlock(MemoryBlock& block, VkDeviceSize offset, uint32_t order) {
+    uint32_t minOrder = block.maxOrder + 1 - static_cast<uint32_t>(block.freeLists.size());
+    block.freeBytes += VkDeviceSize(1) << order;
+
+    // Merge with the buddy for as long as it is free as well.
+    while (order < block.maxOrder) {
+        VkDeviceSize buddy = offset ^ (VkDeviceSize(1) << order);
+        auto& freeList = block.freeLists[order - minOrder];
+        auto it = freeList.find(buddy);
+        if (it == freeList.end()) {
+            break;
+        }
+        freeList.erase(it);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+    block.freeLists[order - minOrder].insert(offset);
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocate(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex,
+                                                 AllocationKind kind) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (memoryTypeIndex >= memoryProperties.memoryTypeCount || !(requirements.memoryTypeBits & (1u << memoryTypeIndex))) {
+        VG_LOG_ERROR("Memory type ", memoryTypeIndex, " is not allowed by typeBits ", requirements.memoryTypeBits);
+        throw std::runtime_error("Invalid memory type for allocation!");
+    }
+
+    // Rounding up to a power of two >= alignment gives natural alignment for free.
+    uint32_t order = std::max({ ceilLog2(requirements.size), ceilLog2(requirements.alignment), getMinOrder(memoryTypeIndex) });
+    uint32_t blockOrder = floorLog2(getBlockSize(memoryTypeIndex));
+
+    MemoryAllocation allocation;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+
+    if (order < blockOrder) {
+        uint32_t blockIndex = MemoryAllocation::kDedicatedBlock;
+        VkDeviceSize offset = 0;
+        for (uint32_t i = 0; i < blocks.size(); i++) {
+            MemoryBlock* block = blocks[i].get();
+            if (block && block->memoryTypeIndex == memoryTypeIndex && block->kind == kind && allocateFromBlock(*block, order, offset)) {
+                blockIndex = i;
+                break;
+            }
+        }
+        if (blockIndex == MemoryAllocation::kDedicatedBlock) {
+            blockIndex = createBlock(memoryTypeIndex, kind, order);
+            if (blockIndex != MemoryAllocation::kDedicatedBlock) {
+                allocateFromBlock(*blocks[blockIndex], order, offset);
+            }
+        }
+
+        if (blockIndex != MemoryAllocation::kDedicatedBlock) {
+            MemoryBlock& block = *blocks[blockIndex];
+            allocation.memory = block.memory;
+            allocation.offset = offset;
+            allocation.size = VkDeviceSize(1) << order;
+            allocation.mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + offset : nullptr;
+            allocation.blockIndex = blockIndex;
+            allocation.order = static_cast<uint8_t>(order);
+            allocationCount++;
+            allocatedBytes += allocation.size;
+            return allocation;
+        }
+    }
+
+    // Too large for a block (or no block could be created): give it its own memory.
+    VkDeviceSize size = requirements.size;
+    if (!isCoherent(memoryTypeIndex) && isHostVisible(memoryTypeIndex)) {
+        size = (size + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize;
+    }
+    allocation.memory = allocateDeviceMemory(size, memoryTypeIndex, &allocation.mappedData);
+    if (allocation.memory == VK_NULL_HANDLE) {
+        VG_LOG_ERROR("Failed to allocate ", requirements.size, " bytes of device memory on type ", memoryTypeIndex);
+        throw std::runtime_error("Failed to allocate device memory!");
+    }
+    allocation.size = size;
+    allocation.blockIndex = MemoryAllocation::kDedicatedBlock;
+    dedicatedMemory.emplace(allocation.memory, allocation.mappedData);
+    allocationCount++;
+    allocatedBytes += size;
+    VG_LOG_DEBUG("Dedicated allocation of ", size, " bytes on memory type ", memoryTypeIndex);
+    return allocation;
+}
+
+void DeviceMemoryAllocator::free(MemoryAllocation& allocation) {
+    if (!allocation.isValid()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    allocationCount--;
+    allocatedBytes -= allocation.size;
+
+    if (allocation.isDedicated()) {
+        freeDeviceMemory(allocation.memory, allocation.mappedData != nullptr);
+        deviceMemoryCount--;
+        dedicatedMemory.erase(allocation.memory);
+        reservedBytes -= allocation.size;
+    } else {
+        MemoryBlock& block = *blocks[allocation.blockIndex];
+        freeToBlock(block, allocation.offset, allocation.order);
+
+        // Release empty blocks, but keep one per memory type and kind to avoid churn.
+        VkDeviceSize blockSize = VkDeviceSize(1) << block.maxOrder;
+        if (block.freeBytes == blockSize) {
+            bool hasSibling = false;
+            for (const auto& other : blocks) {
+                if (other && other.get() != &block && other->memoryTypeIndex == block.memoryTypeIndex && other->kind == block.kind) {
+                    hasSibling = true;
+                    break;
+                }
+            }
+            if (hasSibling) {
+                freeDeviceMemory(block.memory, block.mappedData != nullptr);
+                deviceMemoryCount--;
+                reservedBytes -= blockSize;
+                blocks[allocation.blockIndex].reset();
+            }
+        }
+    }
+    allocation = MemoryAllocation{};
+}
+
+void DeviceMemoryAllocator::mappedRange(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size,
+                                        VkMappedMemoryRange& range) const {
+    if (size == VK_WHOLE_SIZE) {
+        size = allocation.size - offset;
+    }
+    // Widen to whole atoms; allocations are atom aligned so this stays inside them.
+    VkDeviceSize begin = (allocation.offset + offset) / nonCoherentAtomSize * nonCoherentAtomSize;
+    VkDeviceSize end = (allocation.offset + offset + size + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize;
+    end = std::min(end, allocation.offset + allocation.size);
+
+    range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = begin;
+    range.size = end - begin;
+}
+
+void DeviceMemoryAllocator::flush(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) {
+    if (!allocation.isValid() || isCoherent(allocation.memoryTypeIndex)) {
+        return;
+    }
+    VkMappedMemoryRange range;
+    mappedRange(allocation, offset, size, range);
+    vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+void DeviceMemoryAllocator::invalidate(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) {
+    if (!allocation.isValid() || isCoherent(allocation.memoryTypeIndex)) {
+        return;
+    }
+    VkMappedMemoryRange range;
+    mappedRange(allocation, offset, size, range);
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+MemoryAllocatorStats DeviceMemoryAllocator::getStats() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    MemoryAllocatorStats stats;
+    stats.blockCount = deviceMemoryCount - static_cast<uint32_t>(dedicatedMemory.size());
+    stats.dedicatedCount = static_cast<uint32_t>(dedicatedMemory.size());
+    stats.allocationCount = allocationCount;
+    stats.reservedBytes = reservedBytes;
+    stats.allocatedBytes = allocatedBytes;
+    return stats;
+}
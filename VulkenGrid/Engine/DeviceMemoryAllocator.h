@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Tiling of the resource bound to an allocation. Linear (buffers, linear images)
+// and optimal (optimal images) resources are kept in separate blocks, so
+// bufferImageGranularity can never be violated between neighbours.
+enum class AllocationKind : uint8_t {
+    Linear,
+    Optimal
+};
+
+// Lightweight handle to a sub-allocated (or dedicated) range of device memory.
+// Copyable; freed explicitly through DeviceMemoryAllocator::free().
+struct MemoryAllocation {
+    static constexpr uint32_t kDedicatedBlock = UINT32_MAX;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;          // Size actually reserved (power of two inside blocks)
+    void* mappedData = nullptr;     // Persistent mapping for host-visible memory, else nullptr
+    uint32_t memoryTypeIndex = 0;
+    uint32_t blockIndex = kDedicatedBlock;
+    uint8_t order = 0;              // log2(size) for block allocations
+
+    bool isValid() const { return memory != VK_NULL_HANDLE; }
+    bool isDedicated() const { return blockIndex == kDedicatedBlock; }
+};
+
+struct MemoryAllocatorStats {
+    uint32_t blockCount = 0;
+    uint32_t dedicatedCount = 0;
+    uint32_t allocationCount = 0;
+    VkDeviceSize reservedBytes = 0;   // Sum of all VkDeviceMemory objects
+    VkDeviceSize allocatedBytes = 0;  // Bytes handed out to live allocations
+};
+
+/**
+ * @brief Sub-allocates device memory from large per-memory-type blocks using a buddy scheme.
+ *
+ * Blocks are power-of-two sized; a request is rounded up to the next power of
+ * two (and at least its alignment), so every node is naturally aligned to its
+ * own size. Requests larger than half a block get their own VkDeviceMemory.
+ * Host-visible blocks are mapped once at creation and stay mapped.
+ *
+ * All public methods are thread safe.
+ */
+class DeviceMemoryAllocator {
+public:
+    static constexpr VkDeviceSize kDefaultBlockSize = 64ull * 1024 * 1024;
+    static constexpr uint32_t kMinOrder = 8; // 256 byte nodes
+
+    DeviceMemoryAllocator() = default;
+    ~DeviceMemoryAllocator();
+
+    DeviceMemoryAllocator(const DeviceMemoryAllocator&) = delete;
+    DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator&) = delete;
+
+    // Properties are the ones cached by VulkanDevice, so nothing is queried here.
+    void init(VkDevice device, const VkPhysicalDeviceProperties& properties, const VkPhysicalDeviceMemoryProperties& memoryProperties);
+    void cleanup();
+
+    // memoryTypeIndex comes from VulkanDevice::findMemoryType().
+    MemoryAllocation allocate(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex,
+                              AllocationKind kind = AllocationKind::Linear);
+    void free(MemoryAllocation& allocation);
+
+    // Makes host writes visible to the device; no-op for coherent memory.
+    void flush(const MemoryAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+    // Makes device writes visible to the host; no-op for coherent memory.
+    void invalidate(const MemoryAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+    MemoryAllocatorStats getStats() const;
+
+private:
+    struct MemoryBlock {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mappedData = nullptr;
+        uint32_t memoryTypeIndex = 0;
+        AllocationKind kind = AllocationKind::Linear;
+        uint32_t maxOrder = 0;
+        VkDeviceSize freeBytes = 0;
+        // Free node offsets per order, indexed by order - minOrder.
+        std::vector<std::set<VkDeviceSize>> freeLists;
+    };
+
+    uint32_t getMinOrder(uint32_t memoryTypeIndex) const;
+    VkDeviceSize getBlockSize(uint32_t memoryTypeIndex) const;
+    bool isHostVisible(uint32_t memoryTypeIndex) const;
+    bool isCoherent(uint32_t memoryTypeIndex) const;
+
+    VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData);
+    void freeDeviceMemory(VkDeviceMemory memory, bool mapped);
+
+    bool allocateFromBlock(MemoryBlock& block, uint32_t order, VkDeviceSize& offset);
+    void freeToBlock(MemoryBlock& block, VkDeviceSize offset, uint32_t order);
+    uint32_t createBlock(uint32_t memoryTypeIndex, AllocationKind kind, uint32_t minimumOrder);
+    void mappedRange(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size, VkMappedMemoryRange& range) const;
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    VkDeviceSize nonCoherentAtomSize = 1;
+    VkDeviceSize bufferImageGranularity = 1;
+    uint32_t maxMemoryAllocationCount = 0;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<MemoryBlock>> blocks; // Freed blocks leave a null slot so indices stay stable
+    uint32_t deviceMemoryCount = 0;
+    // Live dedicated allocations and their mappings, so cleanup() can free them.
+    std::unordered_map<VkDeviceMemory, void*> dedicatedMemory;
+    uint32_t allocationCount = 0;
+    VkDeviceSize reservedBytes = 0;
+    VkDeviceSize allocatedBytes = 0;
+};
@@ -0,0 +1,102 @@
+#include "DynamicRingBuffer.h"
+#include "VulkanDevice.h"
+#include <algorithm>
+#include <stdexcept>
+
+DynamicRingBuffer::DynamicRingBuffer(VulkanDevice& device, VkDeviceSize capacity, VkBufferUsageFlags usage)
+    : device(device), buffer(device), capacity(capacity), usage(usage) {}
+
+DynamicRingBuffer::~DynamicRingBuffer() {
+    cleanup();
+}
+
+void DynamicRingBuffer::init() {
+    VG_LOG_INFO("Creating dynamic ring buffer of ", capacity / 1024, " KB...");
+    buffer.createBuffer(capacity, usage, MemoryUsage::Dynamic);
+    mappedData = static_cast<char*>(buffer.getMappedData());
+
+    const VkPhysicalDeviceLimits& limits = device.getProperties().limits;
+    defaultAlignment = std::max({ limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment, VkDeviceSize(16) });
+
+    head = tail = frameStart = 0;
+    inFlight.clear();
+    VG_LOG_INFO("Dynamic ring buffer created. Default alignment: ", defaultAlignment);
+}
+
+void DynamicRingBuffer::cleanup() {
+    if (buffer.getBuffer() == VK_NULL_HANDLE) {
+        return;
+    }
+    buffer.cleanup();
+    mappedData = nullptr;
+    inFlight.clear();
+    VG_LOG_INFO("Dynamic ring buffer destroyed.");
+}
+
+void DynamicRingBuffer::beginFrame(uint64_t frameNumber, uint64_t completedFrameNumber) {
+    // An abandoned frame is begun again under the same number and keeps its data.
+    if (frameNumber != currentFrame) {
+        if (currentFrame != 0 && head != frameStart) {
+            inFlight.push_back({ currentFrame, head });
+        }
+        currentFrame = frameNumber;
+        frameStart = head;
+    }
+
+    while (!inFlight.empty() && inFlight.front().frameNumber <= completedFrameNumber) {
+        tail = inFlight.front().end;
+        inFlight.pop_front();
+    }
+    // Nothing live at all: rewind so the next frame starts with the whole ring contiguous.
+    if (inFlight.empty() && head == tail) {
+        head = tail = frameStart = 0;
+    }
+}
+
+RingAllocation DynamicRingBuffer::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    if (alignment == 0) {
+        alignment = defaultAlignment;
+    }
+    VkDeviceSize offset = (head + alignment - 1) / alignment * alignment;
+
+    // Strict comparisons against tail keep head == tail meaning "empty".
+    bool fits;
+    if (head >= tail) {
+        fits = offset + size <= capacity;
+        if (!fits && size < tail) {
+            offset = 0; // Wrap; the unused end of the buffer is reclaimed with this frame
+            fits = true;
+        }
+    } else {
+        fits = offset + size < tail;
+    }
+
+    if (!fits) {
+        VG_LOG_ERROR("Dynamic ring buffer exhausted: requested ", size, " bytes with ", getUsedBytes(), " of ", capacity, " in use.");
+        throw std::runtime_error("Dynamic ring buffer exhausted; increase its capacity!");
+    }
+
+    head = offset + size;
+    RingAllocation allocation;
+    allocation.buffer = buffer.getBuffer();
+    allocation.offset = offset;
+    allocation.size = size;
+    allocation.data = mappedData + offset;
+    return allocation;
+}
+
+void DynamicRingBuffer::flush() {
+    DeviceMemoryAllocator& allocator = device.getAllocator();
+    if (head >= frameStart) {
+        if (head > frameStart) {
+            allocator.flush(buffer.getAllocation(), frameStart, head - frameStart);
+        }
+    } else {
+        allocator.flush(buffer.getAllocation(), frameStart, capacity - frameStart);
+        allocator.flush(buffer.getAllocation(), 0, head);
+    }
+}
+
+VkDeviceSize DynamicRingBuffer::getUsedBytes() const {
+    return head >= tail ? head - tail : capacity - tail + head;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+
+#include "VulkanBuffer.h"
+
+class VulkanDevice;
+
+// Transient range inside a DynamicRingBuffer; valid until the frame that allocated it retires.
+struct RingAllocation {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;   // Bind/descriptor offset into buffer
+    VkDeviceSize size = 0;
+    void* data = nullptr;      // Host pointer to write the contents through
+
+    bool isValid() const { return buffer != VK_NULL_HANDLE; }
+};
+
+/**
+ * @brief Persistently mapped ring for per-frame uniforms, vertices and indices.
+ *
+ * Allocation is a pointer bump; nothing is mapped, allocated or freed on the
+ * hot path. Each frame's end position is remembered, and the space is handed
+ * back once FrameContextRing reports that frame as completed.
+ */
+class DynamicRingBuffer {
+public:
+    static constexpr VkDeviceSize kDefaultCapacity = 8ull * 1024 * 1024;
+    static constexpr VkBufferUsageFlags kDefaultUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                                        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+    DynamicRingBuffer(VulkanDevice& device, VkDeviceSize capacity = kDefaultCapacity, VkBufferUsageFlags usage = kDefaultUsage);
+    ~DynamicRingBuffer();
+
+    void init();
+    void cleanup();
+
+    // Call right after FrameContextRing::beginFrame(). Closes the previous frame
+    // and reclaims everything written by frames up to completedFrameNumber.
+    void beginFrame(uint64_t frameNumber, uint64_t completedFrameNumber);
+
+    // Alignment 0 uses the device's uniform/storage offset alignment, which is
+    // also valid for vertex and index data. Throws if the ring is exhausted.
+    RingAllocation allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+    template <typename T>
+    RingAllocation push(const T* values, size_t count, VkDeviceSize alignment = 0) {
+        RingAllocation allocation = allocate(sizeof(T) * count, alignment);
+        std::memcpy(allocation.data, values, sizeof(T) * count);
+        return allocation;
+    }
+
+    // Makes this frame's writes visible to the device; no-op on coherent memory.
+    // Call before submitting the frame.
+    void flush();
+
+    VkBuffer getBuffer() const { return buffer.getBuffer(); }
+    VkDeviceSize getCapacity() const { return capacity; }
+    // Bytes held by frames that have not retired yet, including the current one.
+    VkDeviceSize getUsedBytes() const;
+
+private:
+    struct FrameMarker {
+        uint64_t frameNumber;
+        VkDeviceSize end;
+    };
+
+    VulkanDevice& device;
+    VulkanBuffer buffer;
+    VkDeviceSize capacity;
+    VkBufferUsageFlags usage;
+    VkDeviceSize defaultAlignment = 16;
+    char* mappedData = nullptr;
+
+    // Live data is [tail, head), possibly wrapping; head == tail means empty.
+    VkDeviceSize head = 0;
+    VkDeviceSize tail = 0;
+    VkDeviceSize frameStart = 0;
+    uint64_t currentFrame = 0;
+    std::deque<FrameMarker> inFlight;
+};
@@ -0,0 +1,69 @@
+#include "FrameLimiter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <thread>
+
+void FrameLimiter::setTargetFrameRate(double framesPerSecond) {
+    targetFrameRate = std::max(framesPerSecond, 0.0);
+    if (targetFrameRate > 0.0) {
+        framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFrameRate));
+    } else {
+        framePeriod = Clock::duration::zero();
+    }
+    nextFrame = Clock::time_point{};
+}
+
+void FrameLimiter::wait() {
+    if (framePeriod == Clock::duration::zero()) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    // First frame, or more than a frame behind: restart the schedule instead of bursting to catch up.
+    if (nextFrame == Clock::time_point{} || now - nextFrame > framePeriod) {
+        nextFrame = now + framePeriod;
+        return;
+    }
+
+    // Sleep for the bulk and spin the remainder; OS sleeps overshoot by up to a millisecond or so.
+    constexpr auto spinWindow = std::chrono::microseconds(1500);
+    if (nextFrame - now > spinWindow) {
+        std::this_thread::sleep_until(nextFrame - spinWindow);
+    }
+    while (Clock::now() < nextFrame) {
+        std::this_thread::yield();
+    }
+    nextFrame += framePeriod;
+}
+
+void LatencyMonitor::reset(const std::string& newLabel) {
+    if (sampleCount > 0) {
+        report();
+    }
+    label = newLabel;
+    sampleCount = 0;
+    totalMs = 0.0;
+}
+
+void LatencyMonitor::record(Clock::time_point inputTime, Clock::time_point presentTime) {
+    double latencyMs = std::chrono::duration<double, std::milli>(presentTime - inputTime).count();
+    if (sampleCount == 0) {
+        minMs = maxMs = latencyMs;
+    } else {
+        minMs = std::min(minMs, latencyMs);
+        maxMs = std::max(maxMs, latencyMs);
+    }
+    totalMs += latencyMs;
+    sampleCount++;
+
+    if (reportInterval > 0 && sampleCount >= reportInterval) {
+        report();
+        sampleCount = 0;
+        totalMs = 0.0;
+    }
+}
+
+void LatencyMonitor::report() {
+    VG_LOG_INFO("Input-to-present latency [", label, "] over ", sampleCount, " frames: min ", minMs,
+                " ms, avg ", totalMs / sampleCount, " ms, max ", maxMs, " ms");
+}
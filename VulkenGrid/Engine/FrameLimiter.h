@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Caps the CPU frame rate. wait() belongs right before input is polled, so the
+// time spent waiting does not sit between input and present.
+class FrameLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 0 disables the limiter.
+    void setTargetFrameRate(double framesPerSecond);
+    double getTargetFrameRate() const { return targetFrameRate; }
+
+    void wait();
+
+private:
+    double targetFrameRate = 0.0;
+    Clock::duration framePeriod{ 0 };
+    Clock::time_point nextFrame{};
+};
+
+/**
+ * @brief Accumulates input-to-present latency and logs min/avg/max periodically.
+ *
+ * A sample spans from the input poll that fed a frame until its present call
+ * returned. That covers any CPU blocking on frames in flight and on swapchain
+ * image acquisition, which is where present modes and image counts differ;
+ * GPU time after the present call and display scan-out are not included.
+ */
+class LatencyMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LatencyMonitor(uint32_t reportInterval = 300) : reportInterval(reportInterval) {}
+
+    // Starts a new measurement series, e.g. after the presentation policy changed.
+    void reset(const std::string& newLabel);
+    void record(Clock::time_point inputTime, Clock::time_point presentTime);
+
+private:
+    void report();
+
+    std::string label;
+    uint32_t reportInterval;
+    uint32_t sampleCount = 0;
+    double totalMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+};
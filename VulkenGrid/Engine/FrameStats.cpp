@@ -0,0 +1,169 @@
+#include "FrameStats.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+const char* frameMetricName(FrameMetric metric) {
+    switch (metric) {
+    case FrameMetric::CpuTime:
+        return "CPU frame";
+    case FrameMetric::GpuTime:
+        return "GPU frame";
+    case FrameMetric::PresentInterval:
+        return "Present interval";
+    default:
+        return "Unknown";
+    }
+}
+
+FrameStats::FrameStats(uint32_t windowFrames, uint32_t reportInterval)
+    : framesPerSubWindow(std::max(windowFrames / kSubWindows, 1u)), reportInterval(reportInterval) {}
+
+void FrameStats::Histogram::clear() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sumMicroseconds.store(0, std::memory_order_relaxed);
+    maxMicroseconds.store(0, std::memory_order_relaxed);
+    hitches.store(0, std::memory_order_relaxed);
+}
+
+double FrameStats::Histogram::medianMs() const {
+    uint64_t count = 0;
+    for (const auto& bucket : buckets) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    if (count == 0) {
+        return 0.0;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBucketCount; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= (count + 1) / 2) {
+            return std::min(bucketMidpointMs(i), maxMicroseconds.load(std::memory_order_relaxed) / 1000.0);
+        }
+    }
+    return 0.0;
+}
+
+uint32_t FrameStats::bucketIndex(uint64_t microseconds) {
+    microseconds = std::min<uint64_t>(microseconds, (1ull << kMaxExponent) - 1);
+    if (microseconds < kSubBuckets) {
+        return static_cast<uint32_t>(microseconds);
+    }
+    // The highest set bit picks the power of two; the next kSubBucketBits bits the linear step within it.
+    uint32_t exponent = kSubBucketBits;
+    while ((microseconds >> (exponent + 1)) != 0) {
+        exponent++;
+    }
+    uint32_t shift = exponent - kSubBucketBits;
+    uint32_t subBucket = static_cast<uint32_t>(microseconds >> shift) - kSubBuckets;
+    return kSubBuckets * (shift + 1) + subBucket;
+}
+
+double FrameStats::bucketMidpointMs(uint32_t index) {
+    if (index < kSubBuckets) {
+        return (index + 0.5) / 1000.0;
+    }
+    uint32_t shift = index / kSubBuckets - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    double width = static_cast<double>(1ull << shift);
+    return (static_cast<double>(lower) + width / 2.0) / 1000.0;
+}
+
+void FrameStats::record(FrameMetric metric, double ms) {
+    if (!(ms >= 0.0)) {
+        return;
+    }
+    uint64_t microseconds = static_cast<uint64_t>(std::llround(ms * 1000.0));
+    MetricHistory& metricHistory = history(metric);
+    Histogram& window = metricHistory.windows[currentWindow.load(std::memory_order_relaxed)];
+
+    window.buckets[bucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    window.sumMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+
+    uint64_t previousMax = window.maxMicroseconds.load(std::memory_order_relaxed);
+    while (microseconds > previousMax &&
+           !window.maxMicroseconds.compare_exchange_weak(previousMax, microseconds, std::memory_order_relaxed)) {
+    }
+
+    uint64_t hitchThreshold = metricHistory.hitchThresholdMicroseconds.load(std::memory_order_relaxed);
+    if (hitchThreshold != 0 && microseconds > hitchThreshold) {
+        window.hitches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameStats::frameCompleted() {
+    frameCount++;
+    if (frameCount % framesPerSubWindow == 0) {
+        // Hitches are judged against the median of the sub-window that just filled up.
+        uint32_t filled = currentWindow.load(std::memory_order_relaxed);
+        for (auto& metric : metrics) {
+            metric.hitchThresholdMicroseconds.store(static_cast<uint64_t>(metric.windows[filled].medianMs() * kHitchFactor * 1000.0),
+                                                    std::memory_order_relaxed);
+        }
+
+        uint32_t next = (filled + 1) % kSubWindows;
+        for (auto& metric : metrics) {
+            metric.windows[next].clear();
+        }
+        currentWindow.store(next, std::memory_order_relaxed);
+    }
+
+    if (reportInterval != 0 && frameCount % reportInterval == 0) {
+        logSummary();
+    }
+}
+
+FrameStatsSummary FrameStats::getSummary(FrameMetric metric) const {
+    const MetricHistory& metricHistory = history(metric);
+
+    std::array<uint64_t, kBucketCount> merged{};
+    FrameStatsSummary summary;
+    uint64_t sumMicroseconds = 0;
+    uint64_t maxMicroseconds = 0;
+    for (const auto& window : metricHistory.windows) {
+        for (uint32_t i = 0; i < kBucketCount; i++) {
+            merged[i] += window.buckets[i].load(std::memory_order_relaxed);
+        }
+        sumMicroseconds += window.sumMicroseconds.load(std::memory_order_relaxed);
+        maxMicroseconds = std::max(maxMicroseconds, window.maxMicroseconds.load(std::memory_order_relaxed));
+        summary.hitchCount += window.hitches.load(std::memory_order_relaxed);
+    }
+    // Counted from the buckets so percentiles stay consistent with a concurrent record().
+    for (uint64_t bucketCount : merged) {
+        summary.sampleCount += bucketCount;
+    }
+    if (summary.sampleCount == 0) {
+        return summary;
+    }
+
+    summary.meanMs = static_cast<double>(sumMicroseconds) / summary.sampleCount / 1000.0;
+    summary.maxMs = static_cast<double>(maxMicroseconds) / 1000.0;
+
+    const double percentiles[] = { 0.50, 0.95, 0.99 };
+    double* results[] = { &summary.p50Ms, &summary.p95Ms, &summary.p99Ms };
+    uint64_t seen = 0;
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < kBucketCount && next < 3; i++) {
+        seen += merged[i];
+        while (next < 3 && seen >= static_cast<uint64_t>(std::ceil(percentiles[next] * summary.sampleCount))) {
+            *results[next] = std::min(bucketMidpointMs(i), summary.maxMs);
+            next++;
+        }
+    }
+    return summary;
+}
+
+void FrameStats::logSummary() const {
+    for (uint32_t i = 0; i < static_cast<uint32_t>(FrameMetric::Count); i++) {
+        FrameMetric metric = static_cast<FrameMetric>(i);
+        FrameStatsSummary summary = getSummary(metric);
+        if (summary.sampleCount == 0) {
+            continue;
+        }
+        VG_LOG_INFO(frameMetricName(metric), " over ", summary.sampleCount, " frames: p50 ", summary.p50Ms, " ms, p95 ",
+                    summary.p95Ms, " ms, p99 ", summary.p99Ms, " ms, max ", summary.maxMs, " ms, mean ", summary.meanMs,
+                    " ms, ", summary.hitchCount, " hitches");
+    }
+}
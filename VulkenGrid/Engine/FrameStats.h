@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class FrameMetric : uint32_t {
+    CpuTime,          // CPU work of a frame, frame limiter sleep excluded
+    GpuTime,          // GPU time of the render pass, from GpuProfiler
+    PresentInterval,  // Time between consecutive presents
+    Count
+};
+
+const char* frameMetricName(FrameMetric metric);
+
+// Percentiles are histogram bucket midpoints, within ~3% of the true value.
+struct FrameStatsSummary {
+    uint64_t sampleCount = 0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    uint64_t hitchCount = 0; // Samples above kHitchFactor times the previous sub-window's median
+};
+
+/**
+ * @brief Tail-latency statistics of frame times over a sliding window.
+ *
+ * Each metric is a set of fixed-size log-linear histograms (16 linear buckets
+ * per power of two of microseconds), one per sub-window. frameCompleted()
+ * retires the oldest sub-window every windowFrames / kSubWindows frames, so
+ * queries always cover between 3/4 and all of the last windowFrames frames.
+ *
+ * Everything is a relaxed atomic: record() may be called from any thread
+ * (e.g. GPU results arriving late) and getSummary() never blocks recording.
+ * A summary read during a rotation can miss a handful of samples.
+ */
+class FrameStats {
+public:
+    static constexpr uint32_t kSubWindows = 4;
+    static constexpr uint32_t kSubBucketBits = 4;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr uint32_t kMaxExponent = 26;  // Values clamp at 2^26 us (~67 s)
+    static constexpr uint32_t kBucketCount = kSubBuckets * (kMaxExponent - kSubBucketBits + 1);
+    static constexpr double kHitchFactor = 2.0;
+
+    // reportInterval frames between summary log lines; 0 disables logging.
+    explicit FrameStats(uint32_t windowFrames = 600, uint32_t reportInterval = 600);
+
+    void record(FrameMetric metric, double ms);
+    // Advances the sliding window; call once per frame from the render thread.
+    void frameCompleted();
+
+    FrameStatsSummary getSummary(FrameMetric metric) const;
+    void logSummary() const;
+
+    static uint32_t bucketIndex(uint64_t microseconds);
+    static double bucketMidpointMs(uint32_t index);
+
+private:
+    struct Histogram {
+        std::array<std::atomic<uint32_t>, kBucketCount> buckets{};
+        std::atomic<uint64_t> sumMicroseconds{ 0 };
+        std::atomic<uint64_t> maxMicroseconds{ 0 };
+        std::atomic<uint64_t> hitches{ 0 };
+
+        void clear();
+        // Bucket midpoint of the median sample; 0 when empty.
+        double medianMs() const;
+    };
+
+    struct MetricHistory {
+        std::array<Histogram, kSubWindows> windows;
+        // kHitchFactor times the median of the sub-window retired as current at the last rotation; 0 until there is one.
+        std::atomic<uint64_t> hitchThresholdMicroseconds{ 0 };
+    };
+
+    MetricHistory& history(FrameMetric metric) { return metrics[static_cast<uint32_t>(metric)]; }
+    const MetricHistory& history(FrameMetric metric) const { return metrics[static_cast<uint32_t>(metric)]; }
+
+    std::array<MetricHistory, static_cast<size_t>(FrameMetric::Count)> metrics;
+    std::atomic<uint32_t> currentWindow{ 0 };
+    uint32_t framesPerSubWindow;
+    uint32_t reportInterval;
+    uint64_t frameCount = 0;
+};
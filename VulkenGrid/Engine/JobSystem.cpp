@@ -0,0 +1,164 @@
+#include "JobSystem.h"
+#include "Logger.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace {
+    // Owning JobSystem and slot of the current worker thread.
+    thread_local const JobSystem* currentJobSystem = nullptr;
+    thread_local uint32_t currentWorkerIndex = JobSystem::kNoSlot;
+
+    // Shared between the caller of parallelFor and its helper jobs; helpers that
+    // start after every chunk has been claimed still touch it, hence shared_ptr.
+    struct ParallelForState {
+        size_t count = 0;
+        size_t grainSize = 1;
+        size_t chunkCount = 0;
+        const std::function<void(size_t, size_t, uint32_t)>* fn = nullptr;
+        std::atomic<size_t> nextChunk{ 0 };
+        std::atomic<size_t> pendingChunks{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    void runChunks(ParallelForState& state, uint32_t slot) {
+        for (;;) {
+            size_t chunk = state.nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= state.chunkCount) {
+                return;
+            }
+            size_t begin = chunk * state.grainSize;
+            size_t end = std::min(begin + state.grainSize, state.count);
+            try {
+                (*state.fn)(begin, end, slot);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(state.mutex);
+                if (!state.error) {
+                    state.error = std::current_exception();
+                }
+            }
+            if (state.pendingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> guard(state.mutex);
+                state.done.notify_all();
+            }
+        }
+    }
+}
+
+JobSystem::JobSystem(uint32_t workerCount) : workerCount(workerCount) {
+    if (this->workerCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        this->workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+}
+
+JobSystem::~JobSystem() {
+    cleanup();
+}
+
+void JobSystem::init() {
+    if (!workers.empty()) {
+        return;
+    }
+    VG_LOG_INFO("Starting job system with ", workerCount, " worker threads...");
+    stopping = false;
+    workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::cleanup() {
+    if (workers.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(jobsMutex);
+        stopping = true;
+    }
+    jobsAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    VG_LOG_INFO("Job system stopped.");
+}
+
+uint32_t JobSystem::getThreadSlot() const {
+    return currentJobSystem == this ? currentWorkerIndex : workerCount;
+}
+
+void JobSystem::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> guard(jobsMutex);
+        if (workers.empty()) {
+            VG_LOG_ERROR("Job submitted to a job system that is not running.");
+            throw std::runtime_error("Job system is not running!");
+        }
+        jobs.push_back(std::move(job));
+    }
+    jobsAvailable.notify_one();
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    currentJobSystem = this;
+    currentWorkerIndex = index;
+    TraceRecorder::getInstance().setThreadName(("Job worker " + std::to_string(index)).c_str());
+
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    for (;;) {
+        jobsAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        // Drain the queue before exiting so no future is left unsatisfied.
+        if (jobs.empty()) {
+            return;
+        }
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        {
+            VG_TRACE_SCOPE("job");
+            job();
+        }
+        lock.lock();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t, uint32_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t chunkCount = (count + grainSize - 1) / grainSize;
+    uint32_t slot = getThreadSlot();
+
+    // Not worth waking anyone for a single chunk.
+    if (chunkCount == 1 || workers.empty()) {
+        for (size_t begin = 0; begin < count; begin += grainSize) {
+            fn(begin, std::min(begin + grainSize, count), slot);
+        }
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+    state->grainSize = grainSize;
+    state->chunkCount = chunkCount;
+    state->fn = &fn;
+    state->pendingChunks.store(chunkCount, std::memory_order_relaxed);
+
+    size_t helpers = std::min<size_t>(chunkCount - 1, workerCount);
+    for (size_t i = 0; i < helpers; i++) {
+        enqueue([state]() { runChunks(*state, currentWorkerIndex); });
+    }
+    runChunks(*state, slot);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->pendingChunks.load(std::memory_order_acquire) == 0; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Fixed pool of worker threads fed from a shared FIFO queue.
+ *
+ * Every thread that runs jobs has a stable slot index: workers use
+ * [0, workerCount) and the thread that calls parallelFor() takes slot
+ * workerCount. Per-thread resources (command pools, scratch buffers) can be
+ * indexed by getThreadSlot() without any locking.
+ */
+class JobSystem {
+public:
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    // workerCount 0 picks one worker per hardware thread, minus the calling thread.
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    void init();
+    void cleanup();
+
+    // Queues fn on a worker and returns a future for its result.
+    template <typename Fn>
+    auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>>;
+
+    // Runs fn(begin, end, threadSlot) over [0, count) in chunks of grainSize and
+    // blocks until all chunks are done. The calling thread works on chunks too.
+    // The first exception thrown by a chunk is rethrown here.
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t, uint32_t)>& fn);
+
+    uint32_t getWorkerCount() const { return workerCount; }
+    // Number of distinct slot indices: one per worker plus the calling thread.
+    uint32_t getThreadSlotCount() const { return workerCount + 1; }
+    // Slot of the current thread; non-worker threads report workerCount.
+    uint32_t getThreadSlot() const;
+
+private:
+    void enqueue(std::function<void()> job);
+    void workerLoop(uint32_t index);
+
+    uint32_t workerCount;
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsAvailable;
+    bool stopping = false;
+};
+
+template <typename Fn>
+auto JobSystem::submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>> {
+    using Result = std::invoke_result_t<std::decay_t<Fn>>;
+    // std::function needs a copyable callable, so the task lives behind a shared_ptr.
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+    std::future<Result> future = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return future;
+}
@@ -0,0 +1,255 @@
+#include "OffscreenTarget.h"
+#include "VulkanDevice.h"
+#include "VulkanBuffer.h"
+#include <cstring>
+#include <stdexcept>
+
+OffscreenTarget::OffscreenTarget(VulkanDevice& device, VkExtent2D extent, VkFormat format, uint32_t imageCount)
+    : device(device), extent(extent), requestedExtent(extent), format(format), imageCount(imageCount) {}
+
+OffscreenTarget::~OffscreenTarget() {
+    cleanup();
+}
+
+void OffscreenTarget::init() {
+    VG_LOG_INFO("Initializing offscreen target (", extent.width, "x", extent.height, ", ", imageCount, " images)...");
+    if (extent.width == 0 || extent.height == 0 || imageCount == 0) {
+        VG_LOG_ERROR("Offscreen target needs a non-zero extent and image count.");
+        throw std::runtime_error("Invalid offscreen target size!");
+    }
+    createImages();
+    VG_LOG_INFO("Offscreen target initialized.");
+}
+
+void OffscreenTarget::cleanup() {
+    destroyRetired(UINT64_MAX);
+
+    ImageSet current{ std::move(images), std::move(imageViews), std::move(allocations), 0 };
+    destroyImageSet(current);
+    images.clear();
+    imageViews.clear();
+    allocations.clear();
+    latestImage = UINT32_MAX;
+}
+
+void OffscreenTarget::createImages() {
+    VkDevice logicalDevice = device.getDevice();
+    images.assign(imageCount, VK_NULL_HANDLE);
+    imageViews.assign(imageCount, VK_NULL_HANDLE);
+    allocations.assign(imageCount, MemoryAllocation{});
+
+    for (uint32_t i = 0; i < imageCount; i++) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkResult result = vkCreateImage(logicalDevice, &imageInfo, nullptr, &images[i]);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to create offscreen image ", i, ". VkResult: ", result);
+            throw std::runtime_error("Failed to create offscreen image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(logicalDevice, images[i], &memRequirements);
+        uint32_t memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits, MemoryUsage::GpuOnly);
+        allocations[i] = device.getAllocator().allocate(memRequirements, memoryTypeIndex, AllocationKind::Optimal);
+
+        result = vkBindImageMemory(logicalDevice, images[i], allocations[i].memory, allocations[i].offset);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to bind offscreen image memory. VkResult: ", result);
+            throw std::runtime_error("Failed to bind offscreen image memory!");
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = images[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        result = vkCreateImageView(logicalDevice, &viewInfo, nullptr, &imageViews[i]);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to create offscreen image view ", i, ". VkResult: ", result);
+            throw std::runtime_error("Failed to create offscreen image view!");
+        }
+    }
+    nextImage = 0;
+}
+
+void OffscreenTarget::destroyImageSet(ImageSet& set) {
+    VkDevice logicalDevice = device.getDevice();
+    for (auto view : set.views) {
+        if (view != VK_NULL_HANDLE) {
+            vkDestroyImageView(logicalDevice, view, nullptr);
+        }
+    }
+    for (auto image : set.images) {
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(logicalDevice, image, nullptr);
+        }
+    }
+    for (auto& allocation : set.allocations) {
+        if (allocation.isValid()) {
+            device.getAllocator().free(allocation);
+        }
+    }
+    set.views.clear();
+    set.images.clear();
+    set.allocations.clear();
+}
+
+VkResult OffscreenTarget::acquireNextImage(VkSemaphore imageAvailable, uint32_t& imageIndex) {
+    imageIndex = nextImage;
+    nextImage = (nextImage + 1) % imageCount;
+    return VK_SUCCESS;
+}
+
+VkResult OffscreenTarget::present(VkQueue queue, VkSemaphore renderFinished, uint32_t imageIndex) {
+    latestImage = imageIndex;
+    return VK_SUCCESS;
+}
+
+bool OffscreenTarget::recreate(uint64_t retireAfterFrame) {
+    if (requestedExtent.width == 0 || requestedExtent.height == 0) {
+        return false;
+    }
+
+    retiredImages.push_back({ std::move(images), std::move(imageViews), std::move(allocations), retireAfterFrame });
+    images.clear();
+    imageViews.clear();
+    allocations.clear();
+    latestImage = UINT32_MAX;
+
+    extent = requestedExtent;
+    createImages();
+    VG_LOG_INFO("Offscreen target recreated at ", extent.width, "x", extent.height);
+    return true;
+}
+
+void OffscreenTarget::destroyRetired(uint64_t completedFrameNumber) {
+    while (!retiredImages.empty() && retiredImages.front().retireAfterFrame <= completedFrameNumber) {
+        destroyImageSet(retiredImages.front());
+        retiredImages.pop_front();
+    }
+}
+
+uint32_t OffscreenTarget::bytesPerPixel(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        return 4;
+    default:
+        VG_LOG_ERROR("Unsupported readback format: ", format);
+        throw std::runtime_error("Unsupported readback format!");
+    }
+}
+
+void OffscreenTarget::readImage(uint32_t imageIndex, std::vector<uint8_t>& pixels) {
+    VkDevice logicalDevice = device.getDevice();
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * bytesPerPixel(format);
+
+    VulkanBuffer readback(device);
+    readback.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::Readback);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = device.getCommandPool();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkResult result = vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate readback command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate readback command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // The render pass already left the image in TRANSFER_SRC; this only orders the copy after its writes.
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = images[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0; // Tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+    vkCmdCopyImageToBuffer(commandBuffer, images[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.getBuffer(), 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = readback.getBuffer();
+    hostBarrier.offset = 0;
+    hostBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+    vkEndCommandBuffer(commandBuffer);
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence = VK_NULL_HANDLE;
+    vkCreateFence(logicalDevice, &fenceInfo, nullptr, &fence);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    result = vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, fence);
+    if (result == VK_SUCCESS) {
+        result = vkWaitForFences(logicalDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+    }
+    vkDestroyFence(logicalDevice, fence, nullptr);
+    vkFreeCommandBuffers(logicalDevice, device.getCommandPool(), 1, &commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Offscreen readback failed. VkResult: ", result);
+        throw std::runtime_error("Offscreen readback failed!");
+    }
+
+    device.getAllocator().invalidate(readback.getAllocation());
+    pixels.resize(static_cast<size_t>(size));
+    std::memcpy(pixels.data(), readback.getMappedData(), pixels.size());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "DeviceMemoryAllocator.h"
+#include "RenderTarget.h"
+
+class VulkanDevice;
+
+/**
+ * @brief Render target made of plain device-local images, for headless rendering.
+ *
+ * Needs no window, surface or swapchain, so it runs on display-less machines
+ * and on CPU implementations such as lavapipe. Images are handed out round
+ * robin and left in TRANSFER_SRC_OPTIMAL after the pass, ready to be copied
+ * out. RenderPass already keeps a frame from reusing an image the GPU is
+ * still writing, so imageCount only needs to match the frames in flight.
+ */
+class OffscreenTarget : public RenderTarget {
+public:
+    OffscreenTarget(VulkanDevice& device, VkExtent2D extent, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM, uint32_t imageCount = 2);
+    ~OffscreenTarget();
+
+    void init();
+    void cleanup();
+
+    // New size, applied by the next recreate().
+    void setExtent(VkExtent2D newExtent) { requestedExtent = newExtent; }
+
+    // Latest image passed to present(), i.e. the most recently submitted frame.
+    bool hasPresentedImage() const { return latestImage != UINT32_MAX; }
+    uint32_t getLatestImageIndex() const { return latestImage; }
+
+    // Copies an image into pixels as tightly packed rows and waits for the copy.
+    // Blocking; meant for tests and single captures, not per-frame streaming.
+    void readImage(uint32_t imageIndex, std::vector<uint8_t>& pixels);
+    static uint32_t bytesPerPixel(VkFormat format);
+
+    // RenderTarget
+    VkFormat getImageFormat() const override { return format; }
+    VkExtent2D getExtent() const override { return extent; }
+    const std::vector<VkImageView>& getImageViews() const override { return imageViews; }
+    VkImage getImage(uint32_t imageIndex) const override { return images[imageIndex]; }
+    VkImageLayout getFinalLayout() const override { return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; }
+    bool isPresentable() const override { return false; }
+    VkResult acquireNextImage(VkSemaphore imageAvailable, uint32_t& imageIndex) override;
+    VkResult present(VkQueue queue, VkSemaphore renderFinished, uint32_t imageIndex) override;
+    bool recreate(uint64_t retireAfterFrame) override;
+    void destroyRetired(uint64_t completedFrameNumber) override;
+
+private:
+    struct ImageSet {
+        std::vector<VkImage> images;
+        std::vector<VkImageView> views;
+        std::vector<MemoryAllocation> allocations;
+        uint64_t retireAfterFrame = 0;
+    };
+
+    void createImages();
+    void destroyImageSet(ImageSet& set);
+
+    VulkanDevice& device;
+    VkExtent2D extent;
+    VkExtent2D requestedExtent;
+    VkFormat format;
+    uint32_t imageCount;
+    uint32_t nextImage = 0;
+    uint32_t latestImage = UINT32_MAX;
+
+    std::vector<VkImage> images;
+    std::vector<VkImageView> imageViews;
+    std::vector<MemoryAllocation> allocations;
+    std::deque<ImageSet> retiredImages;
+};
@@ -0,0 +1,140 @@
+#include "PresentationPolicy.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    bool parseFrameRate(const std::string& text, double& frameRate) {
+        char* end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || value < 0.0) {
+            return false;
+        }
+        frameRate = value;
+        return true;
+    }
+
+    void applyPolicy(const std::string& text, const char* source, PresentationSettings& settings) {
+        if (!parsePresentationPolicy(text, settings.policy)) {
+            VG_LOG_WARN("Unknown presentation policy '", text, "' from ", source, "; keeping ", presentationPolicyName(settings.policy), ".");
+        }
+    }
+
+    void applyFrameRate(const std::string& text, const char* source, PresentationSettings& settings) {
+        if (!parseFrameRate(text, settings.frameRateLimit)) {
+            VG_LOG_WARN("Invalid frame rate limit '", text, "' from ", source, "; ignoring.");
+        }
+    }
+}
+
+const char* presentationPolicyName(PresentationPolicy policy) {
+    switch (policy) {
+    case PresentationPolicy::LowLatency:  return "low-latency";
+    case PresentationPolicy::Balanced:    return "balanced";
+    case PresentationPolicy::Throughput:  return "throughput";
+    case PresentationPolicy::PowerSaving: return "power-saving";
+    }
+    return "unknown";
+}
+
+bool parsePresentationPolicy(const std::string& text, PresentationPolicy& policy) {
+    const std::string name = toLower(text);
+    if (name == "low-latency" || name == "lowlatency") {
+        policy = PresentationPolicy::LowLatency;
+    } else if (name == "balanced") {
+        policy = PresentationPolicy::Balanced;
+    } else if (name == "throughput") {
+        policy = PresentationPolicy::Throughput;
+    } else if (name == "power-saving" || name == "powersaving" || name == "vsync") {
+        policy = PresentationPolicy::PowerSaving;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+PresentationPolicy nextPresentationPolicy(PresentationPolicy policy) {
+    switch (policy) {
+    case PresentationPolicy::LowLatency:  return PresentationPolicy::Balanced;
+    case PresentationPolicy::Balanced:    return PresentationPolicy::Throughput;
+    case PresentationPolicy::Throughput:  return PresentationPolicy::PowerSaving;
+    case PresentationPolicy::PowerSaving: return PresentationPolicy::LowLatency;
+    }
+    return PresentationPolicy::Balanced;
+}
+
+std::vector<VkPresentModeKHR> presentModePreference(PresentationPolicy policy) {
+    switch (policy) {
+    case PresentationPolicy::LowLatency:
+        return { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    case PresentationPolicy::Balanced:
+        return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    case PresentationPolicy::Throughput:
+        return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    case PresentationPolicy::PowerSaving:
+        return { VK_PRESENT_MODE_FIFO_KHR };
+    }
+    return { VK_PRESENT_MODE_FIFO_KHR };
+}
+
+uint32_t chooseSwapchainImageCount(PresentationPolicy policy, const VkSurfaceCapabilitiesKHR& capabilities) {
+    uint32_t imageCount = capabilities.minImageCount + 1;
+    switch (policy) {
+    case PresentationPolicy::LowLatency:
+        // Fewer queued images means less time between rendering and scan-out.
+        imageCount = std::max(capabilities.minImageCount, 2u);
+        break;
+    case PresentationPolicy::Throughput:
+        imageCount = capabilities.minImageCount + 2;
+        break;
+    case PresentationPolicy::Balanced:
+    case PresentationPolicy::PowerSaving:
+        break;
+    }
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount) {
+        imageCount = capabilities.maxImageCount;
+    }
+    return imageCount;
+}
+
+uint32_t framesInFlightFor(PresentationPolicy policy) {
+    switch (policy) {
+    case PresentationPolicy::LowLatency:  return 1;
+    case PresentationPolicy::Throughput:  return 3;
+    case PresentationPolicy::Balanced:
+    case PresentationPolicy::PowerSaving: return 2;
+    }
+    return 2;
+}
+
+PresentationSettings loadPresentationSettings(int argc, char** argv) {
+    PresentationSettings settings;
+
+    if (const char* policy = std::getenv("VULKANGRID_PRESENT_POLICY")) {
+        applyPolicy(policy, "VULKANGRID_PRESENT_POLICY", settings);
+    }
+    if (const char* limit = std::getenv("VULKANGRID_FPS_LIMIT")) {
+        applyFrameRate(limit, "VULKANGRID_FPS_LIMIT", settings);
+    }
+
+    const std::string policyOption = "--present=";
+    const std::string limitOption = "--fps-limit=";
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.compare(0, policyOption.size(), policyOption) == 0) {
+            applyPolicy(arg.substr(policyOption.size()), "--present", settings);
+        } else if (arg.compare(0, limitOption.size(), limitOption) == 0) {
+            applyFrameRate(arg.substr(limitOption.size()), "--fps-limit", settings);
+        }
+    }
+
+    VG_LOG_INFO("Presentation policy: ", presentationPolicyName(settings.policy),
+                ", frame rate limit: ", settings.frameRateLimit > 0.0 ? std::to_string(settings.frameRateLimit) + " Hz" : std::string("off"));
+    return settings;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Trade-off between input latency, throughput and power for presentation.
+enum class PresentationPolicy {
+    LowLatency,   // IMMEDIATE/MAILBOX, fewest images, one frame in flight
+    Balanced,     // MAILBOX else FIFO, minImageCount + 1, two frames in flight
+    Throughput,   // MAILBOX/IMMEDIATE, extra images, three frames in flight
+    PowerSaving   // FIFO (vsync), minImageCount + 1, two frames in flight
+};
+
+struct PresentationSettings {
+    PresentationPolicy policy = PresentationPolicy::Balanced;
+    double frameRateLimit = 0.0; // CPU frame cap in Hz; 0 = uncapped
+};
+
+const char* presentationPolicyName(PresentationPolicy policy);
+// Accepts low-latency, balanced, throughput and power-saving (case-insensitive).
+bool parsePresentationPolicy(const std::string& text, PresentationPolicy& policy);
+PresentationPolicy nextPresentationPolicy(PresentationPolicy policy);
+
+// Present modes in order of preference; FIFO, which is always supported, is last.
+std::vector<VkPresentModeKHR> presentModePreference(PresentationPolicy policy);
+uint32_t chooseSwapchainImageCount(PresentationPolicy policy, const VkSurfaceCapabilitiesKHR& capabilities);
+uint32_t framesInFlightFor(PresentationPolicy policy);
+
+// Defaults, overridden by VULKANGRID_PRESENT_POLICY / VULKANGRID_FPS_LIMIT and then by
+// the --present=<policy> / --fps-limit=<hz> command line options.
+PresentationSettings loadPresentationSettings(int argc, char** argv);
@@ -0,0 +1,165 @@
+#include "ReadbackManager.h"
+#include "VulkanDevice.h"
+#include "OffscreenTarget.h"
+#include <algorithm>
+#include <stdexcept>
+
+ReadbackManager::ReadbackManager(VulkanDevice& device, uint32_t poolSize)
+    : device(device), poolSize(std::max(poolSize, 1u)) {}
+
+ReadbackManager::~ReadbackManager() {
+    cleanup();
+}
+
+void ReadbackManager::init() {
+    VG_LOG_INFO("Initializing readback manager with ", poolSize, " buffers...");
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = device.getQueueFamilyIndices().graphicsFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    VkResult result = vkCreateCommandPool(device.getDevice(), &poolInfo, nullptr, &commandPool);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create readback command pool. VkResult: ", result);
+        throw std::runtime_error("Failed to create readback command pool!");
+    }
+
+    std::vector<VkCommandBuffer> commandBuffers(poolSize);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = poolSize;
+
+    result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate readback command buffers. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate readback command buffers!");
+    }
+
+    for (uint32_t i = 0; i < poolSize; i++) {
+        slots.push_back(std::make_unique<Slot>(device));
+        slots.back()->commandBuffer = commandBuffers[i];
+    }
+    VG_LOG_INFO("Readback manager initialized.");
+}
+
+void ReadbackManager::cleanup() {
+    if (commandPool == VK_NULL_HANDLE) {
+        return;
+    }
+    // Destroying the pool frees its command buffers; callers have waited for the GPU by now.
+    slots.clear();
+    vkDestroyCommandPool(device.getDevice(), commandPool, nullptr);
+    commandPool = VK_NULL_HANDLE;
+    VG_LOG_INFO("Readback manager destroyed (", deliveredCount, " frames delivered, ", droppedCount, " dropped).");
+}
+
+VkCommandBuffer ReadbackManager::recordCopy(uint64_t frameNumber, VkImage image, VkImageLayout layout, VkExtent2D extent, VkFormat format) {
+    auto free = std::find_if(slots.begin(), slots.end(), [](const std::unique_ptr<Slot>& slot) { return !slot->pending; });
+    if (free == slots.end()) {
+        droppedCount++;
+        VG_LOG_DEBUG("All readback buffers in flight; skipping capture of frame ", frameNumber);
+        return VK_NULL_HANDLE;
+    }
+    Slot& slot = **free;
+
+    uint32_t rowPitch = extent.width * OffscreenTarget::bytesPerPixel(format);
+    VkDeviceSize size = static_cast<VkDeviceSize>(rowPitch) * extent.height;
+    // Buffers only grow, so a steady stream never reallocates.
+    if (slot.buffer.getSize() < size) {
+        slot.buffer.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::Readback);
+    }
+
+    VkCommandBuffer commandBuffer = slot.commandBuffer;
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin readback command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin readback command buffer!");
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    // Chains with the render pass's subpass-to-EXTERNAL dependency, which orders its final layout transition first.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = { extent.width, extent.height, 1 };
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer.getBuffer(), 1, &region);
+
+    // Hand the image back in the layout the rest of the frame expects (e.g. PRESENT_SRC).
+    if (layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = layout;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = slot.buffer.getBuffer();
+    hostBarrier.offset = 0;
+    hostBarrier.size = size;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record readback command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record readback command buffer!");
+    }
+
+    slot.pending = true;
+    slot.frameNumber = frameNumber;
+    slot.extent = extent;
+    slot.format = format;
+    slot.size = size;
+    return commandBuffer;
+}
+
+void ReadbackManager::poll(uint64_t completedFrameNumber) {
+    for (;;) {
+        // Oldest completed capture first so consumers see frames in order.
+        Slot* next = nullptr;
+        for (auto& slot : slots) {
+            if (slot->pending && slot->frameNumber <= completedFrameNumber && (!next || slot->frameNumber < next->frameNumber)) {
+                next = slot.get();
+            }
+        }
+        if (!next) {
+            return;
+        }
+
+        device.getAllocator().invalidate(next->buffer.getAllocation(), 0, next->size);
+        if (callback) {
+            ReadbackFrame frame{ next->buffer.getMappedData(), next->size, next->extent, next->format,
+                                 static_cast<uint32_t>(next->size / next->extent.height), next->frameNumber };
+            callback(frame);
+        }
+        next->pending = false;
+        deliveredCount++;
+    }
+}
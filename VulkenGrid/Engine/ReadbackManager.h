@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "VulkanBuffer.h"
+
+class VulkanDevice;
+
+// A completed capture. data is only valid during the callback.
+struct ReadbackFrame {
+    const void* data;
+    VkDeviceSize size;
+    VkExtent2D extent;
+    VkFormat format;
+    uint32_t rowPitch;     // Bytes per row; rows are tightly packed
+    uint64_t frameNumber;  // FrameContextRing number of the frame that was captured
+};
+
+using ReadbackCallback = std::function<void(const ReadbackFrame& frame)>;
+
+/**
+ * @brief Streams rendered images back to the host through a pool of readback buffers.
+ *
+ * recordCopy() records a vkCmdCopyImageToBuffer into a free pool slot's own
+ * command buffer, which the caller submits right after the frame's commands.
+ * poll() hands every capture whose frame has completed on the GPU to the
+ * callback, typically a few frames later; nothing waits on the queue. When all
+ * slots are still in flight the frame is skipped rather than stalling, so the
+ * pool size should exceed the frames in flight.
+ *
+ * The callback runs on the thread calling poll() and should hand the data off
+ * quickly (e.g. copy into an encoder queue).
+ */
+class ReadbackManager {
+public:
+    static constexpr uint32_t kDefaultPoolSize = 4;
+
+    ReadbackManager(VulkanDevice& device, uint32_t poolSize = kDefaultPoolSize);
+    ~ReadbackManager();
+
+    void init();
+    void cleanup();
+
+    void setCallback(ReadbackCallback newCallback) { callback = std::move(newCallback); }
+    bool hasCallback() const { return static_cast<bool>(callback); }
+
+    // Returns a command buffer copying image (currently in layout, which it is
+    // returned to) for frameNumber, or VK_NULL_HANDLE if every slot is busy.
+    // The image must have been created with TRANSFER_SRC usage.
+    VkCommandBuffer recordCopy(uint64_t frameNumber, VkImage image, VkImageLayout layout, VkExtent2D extent, VkFormat format);
+
+    // Delivers captures of frames <= completedFrameNumber, oldest first.
+    void poll(uint64_t completedFrameNumber);
+
+    uint64_t getDeliveredCount() const { return deliveredCount; }
+    uint64_t getDroppedCount() const { return droppedCount; }
+
+private:
+    struct Slot {
+        VulkanBuffer buffer;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        bool pending = false;
+        uint64_t frameNumber = 0;
+        VkExtent2D extent{ 0, 0 };
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkDeviceSize size = 0;
+
+        explicit Slot(VulkanDevice& device) : buffer(device) {}
+    };
+
+    VulkanDevice& device;
+    uint32_t poolSize;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::vector<std::unique_ptr<Slot>> slots;
+    ReadbackCallback callback;
+    uint64_t deliveredCount = 0;
+    uint64_t droppedCount = 0;
+};
@@ -0,0 +1,445 @@
+#include "UploadManager.h"
+#include "VulkanDevice.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // Image copies need the buffer offset to be a multiple of the texel size and of 4.
+    constexpr VkDeviceSize kImageStagingAlignment = 16;
+    constexpr VkDeviceSize kBufferStagingAlignment = 4;
+}
+
+UploadManager::UploadManager(VulkanDevice& device, VkDeviceSize chunkSize)
+    : device(device), chunkSize(chunkSize) {}
+
+UploadManager::~UploadManager() {
+    cleanup();
+}
+
+void UploadManager::init() {
+    VG_LOG_INFO("Initializing upload manager on queue family ", device.getTransferQueueFamily(), "...");
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = device.getTransferQueueFamily();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    VkResult result = vkCreateCommandPool(device.getDevice(), &poolInfo, nullptr, &commandPool);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create transfer command pool. VkResult: ", result);
+        throw std::runtime_error("Failed to create transfer command pool!");
+    }
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    result = vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &timelineSemaphore);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create upload timeline semaphore. VkResult: ", result);
+        throw std::runtime_error("Failed to create upload timeline semaphore!");
+    }
+    lastSubmittedValue = 0;
+    VG_LOG_INFO("Upload manager initialized.");
+}
+
+void UploadManager::cleanup() {
+    if (commandPool == VK_NULL_HANDLE) {
+        return;
+    }
+
+    wait(lastSubmittedValue);
+    if (!pending.empty()) {
+        VG_LOG_WARN("Upload manager destroyed with ", pending.size(), " unsubmitted copies.");
+    }
+    pending.clear();
+    submits.clear();
+    chunks.clear();
+
+    vkDestroyCommandPool(device.getDevice(), commandPool, nullptr);
+    commandPool = VK_NULL_HANDLE;
+    if (timelineSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device.getDevice(), timelineSemaphore, nullptr);
+        timelineSemaphore = VK_NULL_HANDLE;
+    }
+    VG_LOG_INFO("Upload manager cleaned up.");
+}
+
+void UploadManager::setReaderTimeline(VkSemaphore semaphore, uint64_t value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    readerSemaphore = semaphore;
+    readerValue = value;
+}
+
+uint64_t UploadManager::getLastSubmittedValue() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return lastSubmittedValue;
+}
+
+uint64_t UploadManager::getCompletedValue() const {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(device.getDevice(), timelineSemaphore, &value);
+    return value;
+}
+
+void UploadManager::wait(uint64_t value) const {
+    if (value == 0 || timelineSemaphore == VK_NULL_HANDLE) {
+        return;
+    }
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timelineSemaphore;
+    waitInfo.pValues = &value;
+    vkWaitSemaphores(device.getDevice(), &waitInfo, UINT64_MAX);
+}
+
+uint64_t UploadManager::getCompletedReaderValue() const {
+    // Without a reader timeline no frame with inline uploads is in flight.
+    if (readerSemaphore == VK_NULL_HANDLE) {
+        return UINT64_MAX;
+    }
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(device.getDevice(), readerSemaphore, &value);
+    return value;
+}
+
+UploadManager::StagingChunk& UploadManager::reserveStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+    uint64_t completed = getCompletedValue();
+    uint64_t completedFrame = getCompletedReaderValue();
+
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        StagingChunk& chunk = **it;
+        // Everything the GPU read from this chunk is done and nothing else refers to it.
+        if (chunk.used > 0 && chunk.unsubmittedBytes == 0 && chunk.lastSubmitValue <= completed &&
+            chunk.lastInlineFrame <= completedFrame) {
+            chunk.used = 0;
+            // Oversized chunks made for one big upload are not worth keeping around.
+            if (chunk.buffer.getSize() > chunkSize) {
+                it = chunks.erase(it);
+                continue;
+            }
+        }
+
+        VkDeviceSize candidate = (chunk.used + alignment - 1) / alignment * alignment;
+        if (candidate + size <= chunk.buffer.getSize()) {
+            offset = candidate;
+            chunk.used = candidate + size;
+            chunk.unsubmittedBytes += size;
+            return chunk;
+        }
+        ++it;
+    }
+
+    auto chunk = std::make_unique<StagingChunk>(device);
+    chunk->buffer.createBuffer(std::max(size, chunkSize), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::Upload);
+    VG_LOG_DEBUG("Allocated ", chunk->buffer.getSize() / 1024, " KB staging chunk (", chunks.size() + 1, " total).");
+
+    offset = 0;
+    chunk->used = size;
+    chunk->unsubmittedBytes = size;
+    chunks.push_back(std::move(chunk));
+    return *chunks.back();
+}
+
+void UploadManager::stage(StagingChunk& chunk, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    std::memcpy(static_cast<char*>(chunk.buffer.getMappedData()) + offset, data, static_cast<size_t>(size));
+    device.getAllocator().flush(chunk.buffer.getAllocation(), offset, size);
+}
+
+void UploadManager::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    if (size == 0) {
+        return;
+    }
+
+    VkDeviceSize srcOffset;
+    StagingChunk* chunk;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        chunk = &reserveStaging(size, kBufferStagingAlignment, srcOffset);
+    }
+
+    // The reservation keeps the chunk alive and unrecycled, so copy without the lock.
+    stage(*chunk, srcOffset, data, size);
+
+    std::lock_guard<std::mutex> guard(mutex);
+    pending.push_back({ chunk, srcOffset, size, dstBuffer, dstOffset, ImageUploadRegion{} });
+}
+
+void UploadManager::uploadImage(const ImageUploadRegion& region, const void* data, VkDeviceSize size) {
+    if (size == 0 || region.image == VK_NULL_HANDLE) {
+        return;
+    }
+
+    VkDeviceSize srcOffset;
+    StagingChunk* chunk;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        chunk = &reserveStaging(size, kImageStagingAlignment, srcOffset);
+    }
+
+    stage(*chunk, srcOffset, data, size);
+
+    std::lock_guard<std::mutex> guard(mutex);
+    pending.push_back({ chunk, srcOffset, size, VK_NULL_HANDLE, 0, region });
+}
+
+VkCommandBuffer UploadManager::acquireCommandBuffer() {
+    if (!submits.empty() && submits.front().value <= getCompletedValue()) {
+        VkCommandBuffer commandBuffer = submits.front().commandBuffer;
+        submits.pop_front();
+        vkResetCommandBuffer(commandBuffer, 0);
+        return commandBuffer;
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    VkResult result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, &commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate transfer command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate transfer command buffer!");
+    }
+    return commandBuffer;
+}
+
+void UploadManager::recordCopies(VkCommandBuffer commandBuffer, const std::vector<PendingCopy>& copies) {
+    // Buffer copies: one vkCmdCopyBuffer per (staging chunk, destination) with all its regions.
+    struct CopyGroup {
+        VkBuffer src;
+        VkBuffer dst;
+        std::vector<VkBufferCopy> regions;
+    };
+    std::vector<CopyGroup> groups;
+    std::vector<VkImageMemoryBarrier> toTransfer;
+    std::vector<VkImageMemoryBarrier> toFinal;
+
+    for (const auto& copy : copies) {
+        if (copy.image.image != VK_NULL_HANDLE) {
+            bool seen = std::any_of(toTransfer.begin(), toTransfer.end(),
+                                    [&copy](const VkImageMemoryBarrier& barrier) { return barrier.image == copy.image.image; });
+            if (seen) {
+                continue;
+            }
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = copy.image.image;
+            barrier.subresourceRange.aspectMask = copy.image.aspectMask;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+            barrier.oldLayout = copy.image.currentLayout;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcAccessMask = 0; // Earlier reads are ordered by the reader timeline wait
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            toTransfer.push_back(barrier);
+
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = copy.image.finalLayout;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0; // Made visible to graphics by the timeline semaphore wait
+            toFinal.push_back(barrier);
+            continue;
+        }
+
+        VkBuffer src = copy.chunk->buffer.getBuffer();
+        auto group = std::find_if(groups.begin(), groups.end(),
+                                  [&](const CopyGroup& candidate) { return candidate.src == src && candidate.dst == copy.dstBuffer; });
+        if (group == groups.end()) {
+            groups.push_back({ src, copy.dstBuffer, {} });
+            group = groups.end() - 1;
+        }
+        group->regions.push_back({ copy.srcOffset, copy.dstOffset, copy.size });
+    }
+
+    for (const auto& group : groups) {
+        vkCmdCopyBuffer(commandBuffer, group.src, group.dst, static_cast<uint32_t>(group.regions.size()), group.regions.data());
+    }
+
+    if (toTransfer.empty()) {
+        return;
+    }
+
+    // Source stage TRANSFER chains the layout transitions after the reader timeline wait.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, static_cast<uint32_t>(toTransfer.size()), toTransfer.data());
+    for (const auto& copy : copies) {
+        if (copy.image.image == VK_NULL_HANDLE) {
+            continue;
+        }
+        VkBufferImageCopy region{};
+        region.bufferOffset = copy.srcOffset;
+        region.imageSubresource.aspectMask = copy.image.aspectMask;
+        region.imageSubresource.mipLevel = copy.image.mipLevel;
+        region.imageSubresource.baseArrayLayer = copy.image.baseArrayLayer;
+        region.imageSubresource.layerCount = copy.image.layerCount;
+        region.imageOffset = copy.image.offset;
+        region.imageExtent = copy.image.extent;
+        vkCmdCopyBufferToImage(commandBuffer, copy.chunk->buffer.getBuffer(), copy.image.image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                         0, nullptr, 0, nullptr, static_cast<uint32_t>(toFinal.size()), toFinal.data());
+}
+
+bool UploadManager::recordInline(VkCommandBuffer commandBuffer, uint64_t frameNumber) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (pending.empty()) {
+        return false;
+    }
+    // All or nothing, so inline copies never overtake older ones left for the transfer queue.
+    VkDeviceSize totalBytes = 0;
+    for (const auto& copy : pending) {
+        if (copy.image.image != VK_NULL_HANDLE) {
+            return false;
+        }
+        totalBytes += copy.size;
+    }
+    if (totalBytes > inlineBudget) {
+        return false;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin inline upload command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin inline upload command buffer!");
+    }
+
+    // Same queue as the earlier frames, so this orders the copies after all their reads.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+                         0, nullptr);
+
+    std::vector<PendingCopy> batch(pending.begin(), pending.end());
+    pending.clear();
+    recordCopies(commandBuffer, batch);
+
+    VkMemoryBarrier copyBarrier{};
+    copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    copyBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &copyBarrier, 0,
+                         nullptr, 0, nullptr);
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record inline upload command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record inline upload command buffer!");
+    }
+
+    for (const auto& copy : batch) {
+        copy.chunk->unsubmittedBytes -= copy.size;
+        copy.chunk->lastInlineFrame = frameNumber;
+    }
+    VG_LOG_TRACE("Recorded ", batch.size(), " uploads (", totalBytes, " bytes) inline in frame ", frameNumber);
+    return true;
+}
+
+uint64_t UploadManager::flush() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (pending.empty()) {
+        return lastSubmittedValue;
+    }
+
+    // Take copies in arrival order until the budget is used up.
+    std::vector<PendingCopy> batch;
+    VkDeviceSize batchBytes = 0;
+    while (!pending.empty()) {
+        const PendingCopy& next = pending.front();
+        if (flushBudget != 0 && !batch.empty() && batchBytes + next.size > flushBudget) {
+            break;
+        }
+        batchBytes += next.size;
+        batch.push_back(next);
+        pending.pop_front();
+    }
+    // An image must not be split across flushes since each flush transitions it
+    // from the region's current layout, so pull its remaining regions into this batch as well.
+    for (auto it = pending.begin(); it != pending.end();) {
+        bool sameImage = it->image.image != VK_NULL_HANDLE &&
+                         std::any_of(batch.begin(), batch.end(), [&](const PendingCopy& copy) { return copy.image.image == it->image.image; });
+        if (sameImage) {
+            batchBytes += it->size;
+            batch.push_back(*it);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    VkCommandBuffer commandBuffer = acquireCommandBuffer();
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin transfer command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin transfer command buffer!");
+    }
+    recordCopies(commandBuffer, batch);
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record transfer command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record transfer command buffer!");
+    }
+
+    uint64_t signalValue = lastSubmittedValue + 1;
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+
+    // Destinations may still be read by frames in flight on the graphics queue.
+    VkPipelineStageFlags readerWaitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    if (readerSemaphore != VK_NULL_HANDLE && readerValue > 0) {
+        timelineInfo.waitSemaphoreValueCount = 1;
+        timelineInfo.pWaitSemaphoreValues = &readerValue;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &readerSemaphore;
+        submitInfo.pWaitDstStageMask = &readerWaitStage;
+    }
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timelineSemaphore;
+
+    result = vkQueueSubmit(device.getTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to submit uploads. VkResult: ", result);
+        throw std::runtime_error("Failed to submit uploads!");
+    }
+
+    lastSubmittedValue = signalValue;
+    submits.push_back({ commandBuffer, signalValue });
+    for (const auto& copy : batch) {
+        copy.chunk->unsubmittedBytes -= copy.size;
+        copy.chunk->lastSubmitValue = signalValue;
+    }
+
+    VG_LOG_TRACE("Submitted ", batch.size(), " uploads (", batchBytes, " bytes) as timeline value ", signalValue,
+                 "; ", pending.size(), " deferred.");
+    return signalValue;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "VulkanBuffer.h"
+
+class VulkanDevice;
+
+// Destination region of an image upload; the data is tightly packed.
+struct ImageUploadRegion {
+    VkImage image = VK_NULL_HANDLE;
+    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    uint32_t mipLevel = 0;
+    uint32_t baseArrayLayer = 0;
+    uint32_t layerCount = 1;
+    VkOffset3D offset{ 0, 0, 0 };
+    VkExtent3D extent{ 1, 1, 1 };
+    // Layout the image is in before the upload. UNDEFINED discards its contents, so
+    // partial re-uploads of a live image must pass the layout it is actually in.
+    VkImageLayout currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+};
+
+/**
+ * @brief Batches buffer and image uploads through pooled staging memory onto the transfer queue.
+ *
+ * upload*() may be called from any thread: the data is copied into staging
+ * memory immediately and the copy is queued. flush(), called once per frame
+ * from the render thread, records every queued copy into one command buffer
+ * (one vkCmdCopyBuffer per staging chunk and destination) and submits it on
+ * the transfer queue, signalling a timeline semaphore. Graphics submissions
+ * wait on that value instead of the CPU waiting for the copy.
+ *
+ * The other direction matters just as much: a copy must not overwrite data
+ * that an earlier frame is still reading. setReaderTimeline() names the
+ * graphics timeline and the last value submitted on it, and every flush
+ * waits for that value before its copies run.
+ *
+ * That wait would serialise frames if something is uploaded every frame, so
+ * small per-frame deltas take another route: recordInline() records them at
+ * the head of the frame's own graphics command buffer, ordered against the
+ * earlier frames by a pipeline barrier instead of semaphores. Only bulk loads
+ * go through the transfer queue.
+ *
+ * Destination buffers must allow access from both families; VulkanBuffer does
+ * that automatically for TRANSFER_DST buffers. Images must be created with
+ * VK_SHARING_MODE_CONCURRENT over VulkanDevice::getTransferSharingFamilies()
+ * and are transitioned from their current to their final layout by the upload.
+ */
+class UploadManager {
+public:
+    static constexpr VkDeviceSize kDefaultChunkSize = 16ull * 1024 * 1024;
+    static constexpr VkDeviceSize kDefaultInlineBudget = 1ull * 1024 * 1024;
+
+    UploadManager(VulkanDevice& device, VkDeviceSize chunkSize = kDefaultChunkSize);
+    ~UploadManager();
+
+    void init();
+    void cleanup();
+
+    void uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+    void uploadImage(const ImageUploadRegion& region, const void* data, VkDeviceSize size);
+
+    // Submits queued copies, at most getFlushBudget() bytes of them (always at least
+    // one); the rest wait for the next flush so big loads are spread over frames.
+    // Returns the timeline value that signals once the submitted copies are done,
+    // or the last such value if nothing was queued.
+    uint64_t flush();
+
+    // Flushes wait until semaphore reaches value, the last submission that may read
+    // upload destinations. RenderPass sets this before every frame's uploads; VK_NULL_HANDLE
+    // stops waiting, and must only be set once no frame using inline uploads is in flight.
+    void setReaderTimeline(VkSemaphore semaphore, uint64_t value);
+
+    // When everything queued is buffer copies of at most getInlineBudget() bytes in total,
+    // begins commandBuffer, a primary that frame frameNumber submits on the graphics queue
+    // ahead of its other work, records the copies with their barriers, ends it and returns
+    // true. Otherwise leaves the queue to flush() and returns false. frameNumber must be
+    // the value the frame signals on the reader timeline.
+    bool recordInline(VkCommandBuffer commandBuffer, uint64_t frameNumber);
+
+    // Limit on bytes recordInline() takes; 0 sends everything through the transfer queue.
+    void setInlineBudget(VkDeviceSize bytes) { inlineBudget = bytes; }
+    VkDeviceSize getInlineBudget() const { return inlineBudget; }
+
+    // Limit on bytes submitted per flush(); 0 means unlimited.
+    void setFlushBudget(VkDeviceSize bytes) { flushBudget = bytes; }
+    VkDeviceSize getFlushBudget() const { return flushBudget; }
+
+    VkSemaphore getTimelineSemaphore() const { return timelineSemaphore; }
+    uint64_t getLastSubmittedValue() const;
+    uint64_t getCompletedValue() const;
+    bool isComplete(uint64_t value) const { return getCompletedValue() >= value; }
+    // Blocks the CPU; only for loading screens and shutdown.
+    void wait(uint64_t value) const;
+
+private:
+    struct StagingChunk {
+        VulkanBuffer buffer;
+        VkDeviceSize used = 0;
+        VkDeviceSize unsubmittedBytes = 0; // Reserved or queued but not yet submitted
+        uint64_t lastSubmitValue = 0;      // Timeline value of the last submit reading from it
+        uint64_t lastInlineFrame = 0;      // Last frame whose inline uploads read from it
+
+        explicit StagingChunk(VulkanDevice& device) : buffer(device) {}
+    };
+
+    struct PendingCopy {
+        StagingChunk* chunk;
+        VkDeviceSize srcOffset;
+        VkDeviceSize size;
+        VkBuffer dstBuffer;       // Buffer copies
+        VkDeviceSize dstOffset;
+        ImageUploadRegion image;  // Image copies when image.image is set
+    };
+
+    struct SubmitSlot {
+        VkCommandBuffer commandBuffer;
+        uint64_t value;
+    };
+
+    // Reserves size bytes of staging memory; returns the chunk and offset.
+    StagingChunk& reserveStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    void stage(StagingChunk& chunk, VkDeviceSize offset, const void* data, VkDeviceSize size);
+    VkCommandBuffer acquireCommandBuffer();
+    void recordCopies(VkCommandBuffer commandBuffer, const std::vector<PendingCopy>& copies);
+    uint64_t getCompletedReaderValue() const;
+
+    VulkanDevice& device;
+    VkDeviceSize chunkSize;
+    VkDeviceSize flushBudget = 0;
+    VkDeviceSize inlineBudget = kDefaultInlineBudget;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+    uint64_t lastSubmittedValue = 0;
+    VkSemaphore readerSemaphore = VK_NULL_HANDLE;
+    uint64_t readerValue = 0;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<StagingChunk>> chunks;
+    std::deque<PendingCopy> pending;
+    std::deque<SubmitSlot> submits; // Command buffers in submission order
+};
@@ -1,64 +1,108 @@
 #include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include <cstring>
 #include <stdexcept>
 
+VulkanBuffer::VulkanBuffer(VulkanDevice& device) : device(device) {}
+
+VulkanBuffer::~VulkanBuffer() {
+    cleanup();
+}
+
+VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
+    : device(other.device), buffer(other.buffer), size(other.size), allocation(other.allocation) {
+    other.buffer = VK_NULL_HANDLE;
+    other.size = 0;
+    other.allocation = MemoryAllocation{};
+}
+
 void VulkanBuffer::logMemoryInfo(const char* action, VkDeviceSize size) {
-    std::cout << action << ": " << size / (1024 * 1024) << " MB allocated" << std::endl; // Log in MB
+    VG_LOG_DEBUG(action, ": ", size / 1024, " KB");
+}
+
+void VulkanBuffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+    createBufferImpl(size, usage, [this, properties](uint32_t typeBits) {
+        return device.findMemoryType(typeBits, properties);
+    });
+}
+
+void VulkanBuffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memoryUsage) {
+    createBufferImpl(size, usage, [this, memoryUsage](uint32_t typeBits) {
+        return device.findMemoryType(typeBits, memoryUsage);
+    });
 }
 
-void VulkanBuffer::createBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, 
-                                 VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
-                                 VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+template <typename SelectMemoryType>
+void VulkanBuffer::createBufferImpl(VkDeviceSize size, VkBufferUsageFlags usage, SelectMemoryType selectMemoryType) {
+    cleanup();
+
     // Create the Vulkan buffer
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; 
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create buffer!");
+    // Copy destinations may be written by the transfer queue and read by graphics;
+    // concurrent sharing avoids queue family ownership transfers for them.
+    std::vector<uint32_t> sharingFamilies = device.getTransferSharingFamilies();
+    if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && sharingFamilies.size() > 1) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingFamilies.size());
+        bufferInfo.pQueueFamilyIndices = sharingFamilies.data();
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-    // Log the required memory size
-    logMemoryInfo("Memory requirements", memRequirements.size);
+    VkResult result = vkCreateBuffer(device.getDevice(), &bufferInfo, nullptr, &buffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to create buffer!");
+    }
 
-    // Allocate memory for the buffer
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device.getDevice(), buffer, &memRequirements);
+    logMemoryInfo("Buffer memory requirements", memRequirements.size);
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
+    // Sub-allocate instead of paying for a vkAllocateMemory per buffer
+    try {
+        uint32_t memoryTypeIndex = selectMemoryType(memRequirements.memoryTypeBits);
+        allocation = device.getAllocator().allocate(memRequirements, memoryTypeIndex, AllocationKind::Linear);
+    }
+    catch (const std::exception&) {
+        vkDestroyBuffer(device.getDevice(), buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        throw;
     }
 
-    // Log the allocated memory size
-    logMemoryInfo("Allocated buffer memory", allocInfo.allocationSize);
-
-    // Bind the buffer with the allocated memory
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    result = vkBindBufferMemory(device.getDevice(), buffer, allocation.memory, allocation.offset);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to bind buffer memory. VkResult: ", result);
+        cleanup();
+        throw std::runtime_error("Failed to bind buffer memory!");
+    }
+    this->size = size;
 }
 
-void VulkanBuffer::cleanup(VkDevice device, VkBuffer buffer, VkDeviceMemory bufferMemory) {
-    vkDestroyBuffer(device, buffer, nullptr);
-    vkFreeMemory(device, bufferMemory, nullptr);
-
-    // Log the cleanup action
-    std::cout << "Cleaned up buffer and memory" << std::endl;
+void VulkanBuffer::upload(const void* data, VkDeviceSize dataSize, VkDeviceSize offset) {
+    if (allocation.mappedData == nullptr) {
+        VG_LOG_ERROR("Buffer upload requires host-visible memory.");
+        throw std::runtime_error("Buffer is not host visible!");
+    }
+    if (offset + dataSize > size) {
+        VG_LOG_ERROR("Buffer upload of ", dataSize, " bytes at offset ", offset, " exceeds buffer size ", size);
+        throw std::runtime_error("Buffer upload out of range!");
+    }
+    std::memcpy(static_cast<char*>(allocation.mappedData) + offset, data, static_cast<size_t>(dataSize));
+    device.getAllocator().flush(allocation, offset, dataSize);
 }
 
-uint32_t VulkanBuffer::findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
+void VulkanBuffer::cleanup() {
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device.getDevice(), buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
     }
-
-    throw std::runtime_error("failed to find suitable memory type!");
+    if (allocation.isValid()) {
+        device.getAllocator().free(allocation);
+        logMemoryInfo("Released buffer memory", size);
+    }
+    size = 0;
 }
@@ -1,19 +1,44 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
-#include <iostream>
 #include <stdexcept>
 
+#include "DeviceMemoryAllocator.h"
+
+class VulkanDevice;
+enum class MemoryUsage;
+
+// VkBuffer bound to a range handed out by the device's DeviceMemoryAllocator.
 class VulkanBuffer {
 public:
-    static void createBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, 
-                             VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
-                             VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+    VulkanBuffer(VulkanDevice& device);
+    ~VulkanBuffer();
+
+    VulkanBuffer(const VulkanBuffer&) = delete;
+    VulkanBuffer& operator=(const VulkanBuffer&) = delete;
+    VulkanBuffer(VulkanBuffer&& other) noexcept;
 
-    static void cleanup(VkDevice device, VkBuffer buffer, VkDeviceMemory bufferMemory);
+    // Exact property flags; fails if no memory type has all of them.
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+    // Preset placement with fallback, e.g. MemoryUsage::Dynamic picks ReBAR memory when present.
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memoryUsage);
+    void cleanup();
+
+    // Copies data through the persistent mapping and flushes it; host-visible buffers only.
+    void upload(const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+    VkBuffer getBuffer() const { return buffer; }
+    VkDeviceSize getSize() const { return size; }
+    const MemoryAllocation& getAllocation() const { return allocation; }
+    void* getMappedData() const { return allocation.mappedData; }
 
 private:
-    static uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-    
+    template <typename SelectMemoryType>
+    void createBufferImpl(VkDeviceSize size, VkBufferUsageFlags usage, SelectMemoryType selectMemoryType);
     static void logMemoryInfo(const char* action, VkDeviceSize size);
+
+    VulkanDevice& device;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    MemoryAllocation allocation;
 };
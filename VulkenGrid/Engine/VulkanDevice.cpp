@@ -1,69 +1,227 @@
 #include "VulkanDevice.h"
+#include "TraceRecorder.h"
+#include <algorithm>
 #include <stdexcept>
 #include <sstream>
 
 VulkanDevice::VulkanDevice(VulkanInstance& instance) : instance(instance) {}
 
 void VulkanDevice::init(VkSurfaceKHR surface) {
-    Logger::getInstance().log("Initializing Vulkan Device...");
+    VG_TRACE_SCOPE("VulkanDevice::init");
+    VG_LOG_INFO("Initializing Vulkan Device", surface == VK_NULL_HANDLE ? " (headless)..." : "...");
+    headless = surface == VK_NULL_HANDLE;
     pickPhysicalDevice(surface);
+    cachePhysicalDeviceProperties();
+    queryOptionalFeatures();
     createLogicalDevice(surface);
+    loadExtensionFunctions();
+    allocator.init(device, deviceProperties, memoryProperties);
     createCommandPool();
-    Logger::getInstance().log("Vulkan Device initialized successfully.");
+    VG_LOG_INFO("Vulkan Device initialized successfully.");
 }
 
 void VulkanDevice::cleanup() {
-    Logger::getInstance().log("Cleaning up Vulkan Device...");
+    VG_LOG_INFO("Cleaning up Vulkan Device...");
     if (commandPool != VK_NULL_HANDLE) {
         vkDestroyCommandPool(device, commandPool, nullptr);
-        Logger::getInstance().log("Command pool destroyed successfully.");
+        VG_LOG_INFO("Command pool destroyed successfully.");
     }
+    allocator.cleanup();
     if (device != VK_NULL_HANDLE) {
         vkDestroyDevice(device, nullptr);
-        Logger::getInstance().log("Logical device destroyed successfully.");
+        VG_LOG_INFO("Logical device destroyed successfully.");
     }
 }
 
 void VulkanDevice::pickPhysicalDevice(VkSurfaceKHR surface) {
-    Logger::getInstance().log("Picking physical device...");
+    VG_LOG_INFO("Picking physical device...");
     uint32_t deviceCount = 0;
     VkResult result = vkEnumeratePhysicalDevices(instance.getInstance(), &deviceCount, nullptr);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to enumerate physical devices. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to enumerate physical devices. VkResult: ", result);
         throw std::runtime_error("Failed to enumerate physical devices!");
     }
 
     if (deviceCount == 0) {
-        Logger::getInstance().logError("Failed to find GPUs with Vulkan support!");
+        VG_LOG_ERROR("Failed to find GPUs with Vulkan support!");
         throw std::runtime_error("Failed to find GPUs with Vulkan support!");
     }
 
-    Logger::getInstance().log("Number of physical devices found: " + std::to_string(deviceCount));
+    VG_LOG_INFO("Number of physical devices found: ", deviceCount);
 
     std::vector<VkPhysicalDevice> devices(deviceCount);
     result = vkEnumeratePhysicalDevices(instance.getInstance(), &deviceCount, devices.data());
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to enumerate physical devices. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to enumerate physical devices. VkResult: ", result);
         throw std::runtime_error("Failed to enumerate physical devices!");
     }
 
     for (const auto& device : devices) {
-        Logger::getInstance().log("Evaluating physical device...");
+        VG_LOG_DEBUG("Evaluating physical device...");
         if (isDeviceSuitable(device, surface)) {
             physicalDevice = device;
-            Logger::getInstance().log("Physical device selected.");
+            VG_LOG_INFO("Physical device selected.");
             break;
         }
     }
 
     if (physicalDevice == VK_NULL_HANDLE) {
-        Logger::getInstance().logError("Failed to find a suitable GPU!");
+        VG_LOG_ERROR("Failed to find a suitable GPU!");
         throw std::runtime_error("Failed to find a suitable GPU!");
     }
 }
 
+void VulkanDevice::cachePhysicalDeviceProperties() {
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    constexpr VkDeviceSize legacyBarSize = 256ull * 1024 * 1024;
+    VG_LOG_INFO("Device: ", deviceProperties.deviceName);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        const VkMemoryType& type = memoryProperties.memoryTypes[i];
+        VkDeviceSize heapSize = memoryProperties.memoryHeaps[type.heapIndex].size;
+        VG_LOG_DEBUG("Memory type ", i, ": flags ", type.propertyFlags, ", heap ", type.heapIndex, " (", heapSize / (1024 * 1024), " MB)");
+
+        VkMemoryPropertyFlags barFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        if ((type.propertyFlags & barFlags) == barFlags && heapSize > legacyBarSize) {
+            reBarAvailable = true;
+        }
+    }
+    VG_LOG_INFO("Resizable BAR: ", reBarAvailable ? "available" : "not available");
+}
+
+void VulkanDevice::queryOptionalFeatures() {
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+    std::set<std::string> available;
+    for (const auto& extension : availableExtensions) {
+        available.insert(extension.extensionName);
+    }
+
+    // Not needed for rendering; software implementations often lack it.
+    if (available.count(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        optionalExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    if (available.count(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME)) {
+        VkPhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicStateFeatures{};
+        dynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &dynamicStateFeatures;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+        extendedDynamicStateEnabled = dynamicStateFeatures.extendedDynamicState == VK_TRUE;
+        if (extendedDynamicStateEnabled) {
+            optionalExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+        }
+    }
+    VG_LOG_INFO("Extended dynamic state: ", extendedDynamicStateEnabled ? "available" : "not available");
+}
+
+void VulkanDevice::loadExtensionFunctions() {
+    if (!extendedDynamicStateEnabled) {
+        return;
+    }
+    cmdSetCullModeEXT = reinterpret_cast<PFN_vkCmdSetCullModeEXT>(vkGetDeviceProcAddr(device, "vkCmdSetCullModeEXT"));
+    cmdSetFrontFaceEXT = reinterpret_cast<PFN_vkCmdSetFrontFaceEXT>(vkGetDeviceProcAddr(device, "vkCmdSetFrontFaceEXT"));
+    cmdSetPrimitiveTopologyEXT = reinterpret_cast<PFN_vkCmdSetPrimitiveTopologyEXT>(vkGetDeviceProcAddr(device, "vkCmdSetPrimitiveTopologyEXT"));
+    if (!cmdSetCullModeEXT || !cmdSetFrontFaceEXT || !cmdSetPrimitiveTopologyEXT) {
+        VG_LOG_WARN("Extended dynamic state entry points missing; falling back to static raster state.");
+        extendedDynamicStateEnabled = false;
+    }
+}
+
+void VulkanDevice::cmdSetRasterState(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode, VkFrontFace frontFace,
+                                     VkPrimitiveTopology topology) const {
+    cmdSetCullModeEXT(commandBuffer, cullMode);
+    cmdSetFrontFaceEXT(commandBuffer, frontFace);
+    cmdSetPrimitiveTopologyEXT(commandBuffer, topology);
+}
+
+uint32_t VulkanDevice::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const {
+    uint32_t bestIndex = UINT32_MAX;
+    int bestScore = -1;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+        if (!(typeBits & (1u << i)) || (flags & required) != required) {
+            continue;
+        }
+        int score = 0;
+        for (VkMemoryPropertyFlags bits = flags & preferred; bits != 0; bits &= bits - 1) {
+            score++;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestIndex = i;
+        }
+    }
+
+    if (bestIndex == UINT32_MAX) {
+        VG_LOG_ERROR("Failed to find suitable memory type! typeBits: ", typeBits, ", required: ", required);
+        throw std::runtime_error("Failed to find suitable memory type!");
+    }
+    return bestIndex;
+}
+
+uint32_t VulkanDevice::findMemoryType(uint32_t typeBits, MemoryUsage usage) const {
+    const MemoryTypeRanking& ranking = memoryTypeRankings[static_cast<size_t>(usage)];
+    for (uint32_t i = 0; i < ranking.count; i++) {
+        if (typeBits & (1u << ranking.types[i])) {
+            return ranking.types[i];
+        }
+    }
+    VG_LOG_ERROR("Failed to find suitable memory type! typeBits: ", typeBits, ", usage: ", static_cast<int>(usage));
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+void VulkanDevice::rankMemoryTypes() {
+    // Higher scores first; ties keep driver order. Bits are weighted so the
+    // defining property of each usage always outranks the secondary ones.
+    auto score = [](MemoryUsage usage, VkMemoryPropertyFlags flags) {
+        bool deviceLocal = (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+        bool coherent = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+        bool cached = (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != 0;
+        switch (usage) {
+        case MemoryUsage::GpuOnly:
+            return deviceLocal ? 1 : 0;
+        case MemoryUsage::Upload:
+            // Staging stays out of device-local memory, which ReBAR also exposes as host-visible.
+            return (coherent ? 2 : 0) + (deviceLocal ? 0 : 1);
+        case MemoryUsage::Dynamic:
+            return (deviceLocal ? 2 : 0) + (coherent ? 1 : 0);
+        case MemoryUsage::Readback:
+            return (cached ? 2 : 0) + (coherent ? 1 : 0);
+        }
+        return 0;
+    };
+
+    for (size_t usageIndex = 0; usageIndex < kMemoryUsageCount; usageIndex++) {
+        MemoryUsage usage = static_cast<MemoryUsage>(usageIndex);
+        MemoryTypeRanking& ranking = memoryTypeRankings[usageIndex];
+        ranking.count = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+            if ((flags & VK_MEMORY_PROPERTY_PROTECTED_BIT) ||
+                (usage != MemoryUsage::GpuOnly && !(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))) {
+                continue;
+            }
+            ranking.types[ranking.count++] = i;
+        }
+        std::stable_sort(ranking.types, ranking.types + ranking.count, [&](uint32_t a, uint32_t b) {
+            return score(usage, memoryProperties.memoryTypes[a].propertyFlags) > score(usage, memoryProperties.memoryTypes[b].propertyFlags);
+        });
+        if (ranking.count > 0) {
+            VG_LOG_DEBUG("Memory usage ", usageIndex, " prefers memory type ", ranking.types[0], " of ", ranking.count);
+        }
+    }
+}
+
 void VulkanDevice::createLogicalDevice(VkSurfaceKHR surface) {
-    Logger::getInstance().log("Creating logical device...");
+    VG_LOG_DEBUG("Creating logical device...");
     queueFamilyIndices = findQueueFamilies(physicalDevice, surface);
 
     float queuePriority = 1.0f;
@@ -72,9 +230,12 @@ void VulkanDevice::createLogicalDevice(VkSurfaceKHR surface) {
         queueFamilyIndices.graphicsFamily.value(),
         queueFamilyIndices.presentFamily.value()
     };
+    if (queueFamilyIndices.transferFamily.has_value()) {
+        uniqueQueueFamilies.insert(queueFamilyIndices.transferFamily.value());
+    }
 
     for (uint32_t queueFamily : uniqueQueueFamilies) {
-        Logger::getInstance().log("Setting up queue for queue family index: " + std::to_string(queueFamily));
+        VG_LOG_DEBUG("Setting up queue for queue family index: ", queueFamily);
         VkDeviceQueueCreateInfo queueCreateInfo{};
         queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         queueCreateInfo.queueFamilyIndex = queueFamily;
@@ -84,19 +245,34 @@ void VulkanDevice::createLogicalDevice(VkSurfaceKHR surface) {
     }
 
     VkPhysicalDeviceFeatures deviceFeatures{};
+
+    // Timeline semaphores hand uploads from the transfer queue over to graphics.
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicStateFeatures{};
+    dynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+    dynamicStateFeatures.extendedDynamicState = VK_TRUE;
+    if (extendedDynamicStateEnabled) {
+        vulkan12Features.pNext = &dynamicStateFeatures;
+    }
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &vulkan12Features;
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pEnabledFeatures = &deviceFeatures;
 
     auto extensions = getDeviceExtensions();
+    extensions.insert(extensions.end(), optionalExtensions.begin(), optionalExtensions.end());
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
 
-    Logger::getInstance().log("Enabled Device Extensions:");
+    VG_LOG_DEBUG("Enabled Device Extensions:");
     for (const auto& ext : extensions) {
-        Logger::getInstance().log(std::string(" - ") + ext);
+        VG_LOG_DEBUG(" - ", ext);
     }
 
     if (instance.enableValidationLayers) {
@@ -104,9 +280,9 @@ void VulkanDevice::createLogicalDevice(VkSurfaceKHR surface) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
         createInfo.ppEnabledLayerNames = validationLayers.data();
 
-        Logger::getInstance().log("Enabled Validation Layers:");
+        VG_LOG_DEBUG("Enabled Validation Layers:");
         for (const auto& layer : validationLayers) {
-            Logger::getInstance().log(std::string(" - ") + layer);
+            VG_LOG_DEBUG(" - ", layer);
         }
     } else {
         createInfo.enabledLayerCount = 0;
@@ -114,17 +290,25 @@ void VulkanDevice::createLogicalDevice(VkSurfaceKHR surface) {
 
     VkResult result = vkCreateDevice(physicalDevice, &createInfo, nullptr, &device);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to create logical device! VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to create logical device! VkResult: ", result);
         throw std::runtime_error("Failed to create logical device!");
     }
 
     vkGetDeviceQueue(device, queueFamilyIndices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, queueFamilyIndices.presentFamily.value(), 0, &presentQueue);
-    Logger::getInstance().log("Logical device created successfully.");
+    if (queueFamilyIndices.transferFamily.has_value()) {
+        vkGetDeviceQueue(device, queueFamilyIndices.transferFamily.value(), 0, &transferQueue);
+        VG_LOG_INFO("Using dedicated transfer queue family ", queueFamilyIndices.transferFamily.value());
+    } else {
+        transferQueue = graphicsQueue;
+        VG_LOG_INFO("No dedicated transfer queue; transfers share the graphics queue.");
+    }
+    rankMemoryTypes();
+    VG_LOG_INFO("Logical device created successfully.");
 }
 
 void VulkanDevice::createCommandPool() {
-    Logger::getInstance().log("Creating command pool...");
+    VG_LOG_DEBUG("Creating command pool...");
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
@@ -132,68 +316,111 @@ void VulkanDevice::createCommandPool() {
 
     VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to create command pool! VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to create command pool! VkResult: ", result);
         throw std::runtime_error("Failed to create command pool!");
     }
-    Logger::getInstance().log("Command pool created successfully.");
+    VG_LOG_INFO("Command pool created successfully.");
 }
 
 bool VulkanDevice::isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface) {
-    Logger::getInstance().log("Checking if device is suitable...");
+    VG_LOG_DEBUG("Checking if device is suitable...");
     QueueFamilyIndices indices = findQueueFamilies(device, surface);
     bool extensionsSupported = checkDeviceExtensionSupport(device);
+    bool featuresSupported = checkFeatureSupport(device);
     bool swapChainAdequate = false;
 
-    Logger::getInstance().log("Queue Family Indices completeness: " + std::string(indices.isComplete() ? "Complete" : "Incomplete"));
-    Logger::getInstance().log("Extensions supported: " + std::string(extensionsSupported ? "Yes" : "No"));
+    VG_LOG_DEBUG("Queue Family Indices completeness: ", indices.isComplete() ? "Complete" : "Incomplete");
+    VG_LOG_DEBUG("Extensions supported: ", extensionsSupported ? "Yes" : "No");
+    VG_LOG_DEBUG("Timeline semaphores supported: ", featuresSupported ? "Yes" : "No");
 
-    if (extensionsSupported) {
+    if (surface == VK_NULL_HANDLE) {
+        swapChainAdequate = true;
+    } else if (extensionsSupported) {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device, surface);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
-        Logger::getInstance().log("Swap chain formats count: " + std::to_string(swapChainSupport.formats.size()));
-        Logger::getInstance().log("Swap chain present modes count: " + std::to_string(swapChainSupport.presentModes.size()));
+        VG_LOG_DEBUG("Swap chain formats count: ", swapChainSupport.formats.size());
+        VG_LOG_DEBUG("Swap chain present modes count: ", swapChainSupport.presentModes.size());
     }
 
-    bool isSuitable = indices.isComplete() && extensionsSupported && swapChainAdequate;
-    Logger::getInstance().log("Device suitability: " + std::string(isSuitable ? "Suitable" : "Not Suitable"));
+    bool isSuitable = indices.isComplete() && extensionsSupported && featuresSupported && swapChainAdequate;
+    VG_LOG_DEBUG("Device suitability: ", isSuitable ? "Suitable" : "Not Suitable");
     return isSuitable;
 }
 
+bool VulkanDevice::checkFeatureSupport(VkPhysicalDevice device) const {
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return vulkan12Features.timelineSemaphore == VK_TRUE;
+}
+
+uint32_t VulkanDevice::getTransferQueueFamily() const {
+    return queueFamilyIndices.transferFamily.value_or(queueFamilyIndices.graphicsFamily.value());
+}
+
+std::vector<uint32_t> VulkanDevice::getTransferSharingFamilies() const {
+    std::vector<uint32_t> families = { queueFamilyIndices.graphicsFamily.value() };
+    if (queueFamilyIndices.transferFamily.has_value()) {
+        families.push_back(queueFamilyIndices.transferFamily.value());
+    }
+    return families;
+}
+
 QueueFamilyIndices VulkanDevice::findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface) const {
-    Logger::getInstance().log("Finding queue families...");
+    VG_LOG_DEBUG("Finding queue families...");
     QueueFamilyIndices indices;
 
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
-    Logger::getInstance().log("Queue family count: " + std::to_string(queueFamilyCount));
+    VG_LOG_DEBUG("Queue family count: ", queueFamilyCount);
 
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
     int index = 0;
     for (const auto& queueFamily : queueFamilies) {
-        Logger::getInstance().log("Evaluating queue family index: " + std::to_string(index));
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        VG_LOG_DEBUG("Evaluating queue family index: ", index);
+        if (!indices.graphicsFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
             indices.graphicsFamily = index;
-            Logger::getInstance().log("Graphics queue family found at index: " + std::to_string(index));
+            VG_LOG_DEBUG("Graphics queue family found at index: ", index);
         }
 
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, index, surface, &presentSupport);
+        if (surface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, index, surface, &presentSupport);
+        }
 
-        if (presentSupport) {
+        if (!indices.presentFamily.has_value() && presentSupport) {
             indices.presentFamily = index;
-            Logger::getInstance().log("Present queue family found at index: " + std::to_string(index));
+            VG_LOG_DEBUG("Present queue family found at index: ", index);
         }
 
-        if (indices.isComplete()) {
-            Logger::getInstance().log("Required queue families found.");
-            break;
+        // Prefer a pure transfer family (no graphics, no compute): that is the copy engine.
+        if (!(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT)) {
+            bool pureTransfer = !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT);
+            if (!indices.transferFamily.has_value() || pureTransfer) {
+                indices.transferFamily = index;
+                VG_LOG_DEBUG("Transfer queue family found at index: ", index, pureTransfer ? " (dedicated)" : " (async compute)");
+            }
         }
 
         index++;
     }
 
+    // Headless: nothing is presented, the present queue is just the graphics queue.
+    if (surface == VK_NULL_HANDLE) {
+        indices.presentFamily = indices.graphicsFamily;
+    }
+
+    if (indices.isComplete()) {
+        VG_LOG_DEBUG("Required queue families found.");
+    }
+
     return indices;
 }
 
@@ -202,53 +429,53 @@ SwapChainSupportDetails VulkanDevice::querySwapChainSupport(VkSurfaceKHR surface
 }
 
 SwapChainSupportDetails VulkanDevice::querySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface) const {
-    Logger::getInstance().log("Querying swap chain support...");
+    VG_LOG_DEBUG("Querying swap chain support...");
     SwapChainSupportDetails details;
 
     VkResult result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to get physical device surface capabilities! VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to get physical device surface capabilities! VkResult: ", result);
         throw std::runtime_error("Failed to get physical device surface capabilities!");
     }
 
     uint32_t formatCount;
     vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
-    Logger::getInstance().log("Surface format count: " + std::to_string(formatCount));
+    VG_LOG_DEBUG("Surface format count: ", formatCount);
 
     if (formatCount != 0) {
         details.formats.resize(formatCount);
         vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.formats.data());
-        Logger::getInstance().log("Surface formats retrieved.");
+        VG_LOG_DEBUG("Surface formats retrieved.");
     }
 
     uint32_t presentModeCount;
     vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
-    Logger::getInstance().log("Present mode count: " + std::to_string(presentModeCount));
+    VG_LOG_DEBUG("Present mode count: ", presentModeCount);
 
     if (presentModeCount != 0) {
         details.presentModes.resize(presentModeCount);
         vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
-        Logger::getInstance().log("Present modes retrieved.");
+        VG_LOG_DEBUG("Present modes retrieved.");
     }
 
     return details;
 }
 
 bool VulkanDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) const {
-    Logger::getInstance().log("Checking device extension support...");
+    VG_LOG_DEBUG("Checking device extension support...");
     uint32_t extensionCount = 0;
     VkResult result = vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to enumerate device extension properties! VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to enumerate device extension properties! VkResult: ", result);
         throw std::runtime_error("Failed to enumerate device extension properties!");
     }
 
-    Logger::getInstance().log("Available device extension count: " + std::to_string(extensionCount));
+    VG_LOG_DEBUG("Available device extension count: ", extensionCount);
 
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     result = vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to enumerate device extension properties! VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to enumerate device extension properties! VkResult: ", result);
         throw std::runtime_error("Failed to enumerate device extension properties!");
     }
 
@@ -256,33 +483,36 @@ bool VulkanDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) const {
     std::vector<const char*> deviceExtensions = getDeviceExtensions();
     std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
-    Logger::getInstance().log("Required Device Extensions:");
+    VG_LOG_DEBUG("Required Device Extensions:");
     for (const auto& ext : requiredExtensions) {
-        Logger::getInstance().log(std::string(" - ") + ext);
+        VG_LOG_DEBUG(" - ", ext);
     }
 
-    Logger::getInstance().log("Available Device Extensions:");
+    VG_LOG_DEBUG("Available Device Extensions:");
     for (const auto& extension : availableExtensions) {
-        Logger::getInstance().log(std::string(" - ") + extension.extensionName);
+        VG_LOG_DEBUG(" - ", extension.extensionName);
         requiredExtensions.erase(extension.extensionName);
     }
 
     if (!requiredExtensions.empty()) {
-        Logger::getInstance().log("Missing required device extensions:");
+        VG_LOG_WARN("Missing required device extensions:");
         for (const auto& missingExt : requiredExtensions) {
-            Logger::getInstance().logError(missingExt.c_str());
+            VG_LOG_ERROR(missingExt);
         }
     }
 
-    Logger::getInstance().log("Device extension support " + std::string(requiredExtensions.empty() ? "available" : "not available"));
+    VG_LOG_DEBUG("Device extension support ", requiredExtensions.empty() ? "available" : "not available");
     return requiredExtensions.empty();
 }
 
 std::vector<const char*> VulkanDevice::getDeviceExtensions() const {
+    if (headless) {
+        return { VK_KHR_MAINTENANCE1_EXTENSION_NAME };
+    }
     return {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        VK_KHR_MAINTENANCE1_EXTENSION_NAME,
-        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+        VK_KHR_MAINTENANCE1_EXTENSION_NAME
         // Removed VK_KHR_SURFACE_EXTENSION_NAME as it is an instance extension
+        // VK_EXT_memory_budget is enabled as an optional extension when present
     };
 }
@@ -7,6 +7,7 @@
 #include <string>
 #include <set>
 #include "Logger.h"
+#include "DeviceMemoryAllocator.h"
 
 #ifndef VULKAN_DEVICE_H
 #define VULKAN_DEVICE_H
@@ -14,12 +15,23 @@
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // Transfer-only family (DMA engine) when the device has one; otherwise unset.
+    std::optional<uint32_t> transferFamily;
 
     bool isComplete() const {
         return graphicsFamily.has_value() && presentFamily.has_value();
     }
 };
 
+// Common memory placements, mapped to required/preferred property flags by VulkanDevice.
+enum class MemoryUsage {
+    GpuOnly,   // Device-local, never touched by the CPU
+    Upload,    // CPU-written staging memory, read once by a transfer
+    Dynamic,   // CPU-written every frame, read by shaders; prefers device-local host-visible (ReBAR)
+    Readback   // GPU-written, CPU-read; prefers host-cached
+};
+constexpr size_t kMemoryUsageCount = 4;
+
 struct SwapChainSupportDetails {
     VkSurfaceCapabilitiesKHR capabilities;
     std::vector<VkSurfaceFormatKHR> formats;
@@ -29,14 +41,42 @@ struct SwapChainSupportDetails {
 class VulkanDevice {
 public:
     VulkanDevice(VulkanInstance& instance);
+    // A null surface selects headless mode: no present support or swapchain extension is required.
     void init(VkSurfaceKHR surface);
     void cleanup();
     VkDevice getDevice() const { return device; }
+    bool isHeadless() const { return headless; }
     VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
     VkQueue getGraphicsQueue() const { return graphicsQueue; }
     VkQueue getPresentQueue() const { return presentQueue; }
+    // Dedicated transfer queue, or the graphics queue when there is none.
+    VkQueue getTransferQueue() const { return transferQueue; }
+    uint32_t getTransferQueueFamily() const;
+    bool hasDedicatedTransferQueue() const { return queueFamilyIndices.transferFamily.has_value(); }
+    // Families a resource written by the transfer queue and read by graphics must be shared between.
+    std::vector<uint32_t> getTransferSharingFamilies() const;
     VkCommandPool getCommandPool() const { return commandPool; }
     QueueFamilyIndices getQueueFamilyIndices() const { return queueFamilyIndices; }
+    DeviceMemoryAllocator& getAllocator() { return allocator; }
+
+    // Cached at init; never re-queried.
+    const VkPhysicalDeviceProperties& getProperties() const { return deviceProperties; }
+    const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const { return memoryProperties; }
+
+    // Picks the memory type allowed by typeBits that has every required flag and the
+    // most preferred flags, breaking ties by driver order.
+    uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0) const;
+    // First type allowed by typeBits in the usage's ranking, built at device creation.
+    uint32_t findMemoryType(uint32_t typeBits, MemoryUsage usage) const;
+    // True when a device-local, host-visible heap is larger than the legacy 256 MB BAR window.
+    bool hasReBAR() const { return reBarAvailable; }
+
+    // VK_EXT_extended_dynamic_state is enabled when available; pipelines may then
+    // leave cull mode, front face and topology to the command buffer.
+    bool hasExtendedDynamicState() const { return extendedDynamicStateEnabled; }
+    // Only valid when hasExtendedDynamicState().
+    void cmdSetRasterState(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode, VkFrontFace frontFace,
+                           VkPrimitiveTopology topology) const;
 
     // Overloaded function
     SwapChainSupportDetails querySwapChainSupport(VkSurfaceKHR surface) const;
@@ -48,15 +88,37 @@ private:
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkQueue graphicsQueue = VK_NULL_HANDLE;
     VkQueue presentQueue = VK_NULL_HANDLE;
+    VkQueue transferQueue = VK_NULL_HANDLE;
     VkCommandPool commandPool = VK_NULL_HANDLE;
     QueueFamilyIndices queueFamilyIndices;
+    DeviceMemoryAllocator allocator;
+    VkPhysicalDeviceProperties deviceProperties{};
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    bool reBarAvailable = false;
+    bool headless = false;
+    bool extendedDynamicStateEnabled = false;
+    std::vector<const char*> optionalExtensions; // Supported optional extensions enabled at device creation
+    PFN_vkCmdSetCullModeEXT cmdSetCullModeEXT = nullptr;
+    PFN_vkCmdSetFrontFaceEXT cmdSetFrontFaceEXT = nullptr;
+    PFN_vkCmdSetPrimitiveTopologyEXT cmdSetPrimitiveTopologyEXT = nullptr;
+    // Memory types usable for each MemoryUsage, best first.
+    struct MemoryTypeRanking {
+        uint32_t count = 0;
+        uint32_t types[VK_MAX_MEMORY_TYPES];
+    };
+    MemoryTypeRanking memoryTypeRankings[kMemoryUsageCount];
 
     void pickPhysicalDevice(VkSurfaceKHR surface);
+    void cachePhysicalDeviceProperties();
+    void queryOptionalFeatures();
+    void loadExtensionFunctions();
     void createLogicalDevice(VkSurfaceKHR surface);
+    void rankMemoryTypes();
     void createCommandPool();
     bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface);
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface) const;
     bool checkDeviceExtensionSupport(VkPhysicalDevice device) const;
+    bool checkFeatureSupport(VkPhysicalDevice device) const;
     std::vector<const char*> getDeviceExtensions() const;
 };
 
@@ -15,7 +15,10 @@ public:
     void init();
     void cleanup();
     VkInstance getInstance() const { return instance; }
+    // Cleared by init() when the layers are not installed.
     bool enableValidationLayers = true;
+    // Headless instances request no window-system extensions, so GLFW need not be initialized.
+    bool headless = false;
     const std::vector<const char*>& getValidationLayers() const { return validationLayers; }
 
 private:
@@ -1,36 +1,93 @@
 #include "VulkanSwapChain.h"
 #include "Logger.h"
+#include "TraceRecorder.h"
 #include <stdexcept>
 #include <algorithm>
 
 VulkanSwapchain::VulkanSwapchain(VulkanInstance& instance, VulkanDevice& device, VkSurfaceKHR surface)
-    : instance(instance), device(device), surface(surface) {}
+    : instance(instance), device(device), surface(surface), swapchain(VK_NULL_HANDLE),
+      swapchainImageFormat(VK_FORMAT_UNDEFINED), swapchainExtent{ 0, 0 }, renderPass(VK_NULL_HANDLE),
+      commandBuffer(VK_NULL_HANDLE) {}
 
 void VulkanSwapchain::init() {
-    Logger::getInstance().log("Initializing Vulkan Swapchain...");
+    VG_TRACE_SCOPE("VulkanSwapchain::init");
+    VG_LOG_INFO("Initializing Vulkan Swapchain...");
 
     SwapChainSupportDetails swapChainSupport = device.querySwapChainSupport(surface);
+    createSwapchain(swapChainSupport, VK_NULL_HANDLE);
+    createImageViews();
 
-    Logger::getInstance().log("Available swapchain formats: " + std::to_string(swapChainSupport.formats.size()));
+    VG_LOG_INFO("Vulkan Swapchain and associated resources initialized successfully.");
+}
+
+bool VulkanSwapchain::recreate(uint64_t retireAfterFrame) {
+    SwapChainSupportDetails swapChainSupport = device.querySwapChainSupport(surface);
+    VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
+    if (extent.width == 0 || extent.height == 0) {
+        VG_LOG_DEBUG("Surface extent is zero; deferring swapchain recreation.");
+        return false;
+    }
+
+    VG_LOG_INFO("Recreating swapchain at ", extent.width, "x", extent.height, "...");
+
+    // The old swapchain is retired by vkCreateSwapchainKHR even if creation fails,
+    // so it is queued for destruction up front.
+    VkSwapchainKHR oldSwapchain = swapchain;
+    retiredSwapchains.push_back({ oldSwapchain, std::move(swapchainImageViews), retireAfterFrame });
+    swapchain = VK_NULL_HANDLE;
+    swapchainImageViews.clear();
+    swapchainImages.clear();
+
+    createSwapchain(swapChainSupport, oldSwapchain);
+    createImageViews();
+
+    VG_LOG_INFO("Swapchain recreated; ", retiredSwapchains.size(), " retired swapchain(s) pending destruction.");
+    return true;
+}
+
+void VulkanSwapchain::destroyRetired(uint64_t completedFrameNumber) {
+    while (!retiredSwapchains.empty() && retiredSwapchains.front().retireAfterFrame <= completedFrameNumber) {
+        RetiredSwapchain& retired = retiredSwapchains.front();
+        destroyImageViews(retired.imageViews);
+        vkDestroySwapchainKHR(device.getDevice(), retired.swapchain, nullptr);
+        VG_LOG_DEBUG("Destroyed swapchain retired after frame ", retired.retireAfterFrame);
+        retiredSwapchains.pop_front();
+    }
+}
+
+VkResult VulkanSwapchain::acquireNextImage(VkSemaphore imageAvailable, uint32_t& imageIndex) {
+    return vkAcquireNextImageKHR(device.getDevice(), swapchain, UINT64_MAX, imageAvailable, VK_NULL_HANDLE, &imageIndex);
+}
+
+VkResult VulkanSwapchain::present(VkQueue queue, VkSemaphore renderFinished, uint32_t imageIndex) {
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &renderFinished;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+    return vkQueuePresentKHR(queue, &presentInfo);
+}
+
+void VulkanSwapchain::createSwapchain(const SwapChainSupportDetails& swapChainSupport, VkSwapchainKHR oldSwapchain) {
+    VG_LOG_DEBUG("Available swapchain formats: ", swapChainSupport.formats.size());
     if (swapChainSupport.formats.empty()) {
-        Logger::getInstance().logError("No available swapchain formats!");
+        VG_LOG_ERROR("No available swapchain formats!");
         throw std::runtime_error("No available swapchain formats!");
     }
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-    Logger::getInstance().log("Chosen surface format: " + std::to_string(surfaceFormat.format));
+    VG_LOG_INFO("Chosen surface format: ", surfaceFormat.format);
 
-    VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
-    Logger::getInstance().log("Chosen present mode: " + std::to_string(presentMode));
+    VkPresentModeKHR chosenPresentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    VG_LOG_INFO("Chosen present mode: ", chosenPresentMode, " (", presentationPolicyName(presentationPolicy), " policy)");
 
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
-    Logger::getInstance().log("Chosen swap extent: " + std::to_string(extent.width) + "x" + std::to_string(extent.height));
+    VG_LOG_INFO("Chosen swap extent: ", extent.width, "x", extent.height);
 
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-    if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
-        imageCount = swapChainSupport.capabilities.maxImageCount;
-    }
-    Logger::getInstance().log("Chosen image count for swapchain: " + std::to_string(imageCount));
+    uint32_t imageCount = chooseSwapchainImageCount(presentationPolicy, swapChainSupport.capabilities);
+    VG_LOG_DEBUG("Chosen image count for swapchain: ", imageCount);
 
     VkSwapchainCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -41,6 +98,10 @@ void VulkanSwapchain::init() {
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Lets ReadbackManager capture presented frames.
+    if (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
 
     uint32_t queueFamilyIndices[] = { device.getQueueFamilyIndices().graphicsFamily.value(), device.getQueueFamilyIndices().presentFamily.value() };
 
@@ -48,23 +109,23 @@ void VulkanSwapchain::init() {
         createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
         createInfo.queueFamilyIndexCount = 2;
         createInfo.pQueueFamilyIndices = queueFamilyIndices;
-        Logger::getInstance().log("Using concurrent sharing mode for swapchain images.");
+        VG_LOG_DEBUG("Using concurrent sharing mode for swapchain images.");
     }
     else {
         createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
         createInfo.queueFamilyIndexCount = 0;
         createInfo.pQueueFamilyIndices = nullptr;
-        Logger::getInstance().log("Using exclusive sharing mode for swapchain images.");
+        VG_LOG_DEBUG("Using exclusive sharing mode for swapchain images.");
     }
 
     createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = presentMode;
+    createInfo.presentMode = chosenPresentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = oldSwapchain;
 
     if (vkCreateSwapchainKHR(device.getDevice(), &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to create swapchain!");
+        VG_LOG_ERROR("Failed to create swapchain!");
         throw std::runtime_error("Failed to create swapchain!");
     }
 
@@ -73,14 +134,17 @@ void VulkanSwapchain::init() {
     vkGetSwapchainImagesKHR(device.getDevice(), swapchain, &imageCount, swapchainImages.data());
 
     swapchainImageFormat = surfaceFormat.format;
-    Logger::getInstance().log("Swapchain image format selected: " + std::to_string(swapchainImageFormat));
+    VG_LOG_INFO("Swapchain image format selected: ", swapchainImageFormat);
 
     swapchainExtent = extent;
+    presentMode = chosenPresentMode;
+}
 
-    Logger::getInstance().log("Creating image views...");
+void VulkanSwapchain::createImageViews() {
+    VG_LOG_DEBUG("Creating image views...");
     swapchainImageViews.resize(swapchainImages.size());
     for (size_t i = 0; i < swapchainImages.size(); i++) {
-        Logger::getInstance().log("Creating image view for swapchain image index: " + std::to_string(i));
+        VG_LOG_DEBUG("Creating image view for swapchain image index: ", i);
         VkImageViewCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         createInfo.image = swapchainImages[i];
@@ -97,84 +161,84 @@ void VulkanSwapchain::init() {
         createInfo.subresourceRange.layerCount = 1;
 
         if (vkCreateImageView(device.getDevice(), &createInfo, nullptr, &swapchainImageViews[i]) != VK_SUCCESS) {
-            Logger::getInstance().logError("Failed to create image view at index " + std::to_string(i));
+            VG_LOG_ERROR("Failed to create image view at index ", i);
             throw std::runtime_error("Failed to create image views!");
         }
-        Logger::getInstance().log("Image view created successfully at index: " + std::to_string(i));
+        VG_LOG_DEBUG("Image view created successfully at index: ", i);
     }
+}
 
-    Logger::getInstance().log("Creating semaphores...");
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-    if (vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphore) != VK_SUCCESS ||
-        vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphore) != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to create semaphores!");
-        throw std::runtime_error("Failed to create semaphores!");
+void VulkanSwapchain::destroyImageViews(std::vector<VkImageView>& imageViews) {
+    for (auto imageView : imageViews) {
+        VG_LOG_DEBUG("Destroying image view...");
+        vkDestroyImageView(device.getDevice(), imageView, nullptr);
     }
-
-    Logger::getInstance().log("Vulkan Swapchain and associated resources initialized successfully.");
+    imageViews.clear();
 }
 
 void VulkanSwapchain::cleanup() {
-    Logger::getInstance().log("Cleaning up Vulkan Swapchain...");
+    VG_LOG_INFO("Cleaning up Vulkan Swapchain...");
 
     for (auto framebuffer : swapchainFramebuffers) {
-        Logger::getInstance().log("Destroying framebuffer...");
+        VG_LOG_DEBUG("Destroying framebuffer...");
         vkDestroyFramebuffer(device.getDevice(), framebuffer, nullptr);
     }
 
-    for (auto imageView : swapchainImageViews) {
-        Logger::getInstance().log("Destroying image view...");
-        vkDestroyImageView(device.getDevice(), imageView, nullptr);
-    }
+    swapchainFramebuffers.clear();
 
-    vkDestroySwapchainKHR(device.getDevice(), swapchain, nullptr);
-    vkDestroySemaphore(device.getDevice(), imageAvailableSemaphore, nullptr);
-    vkDestroySemaphore(device.getDevice(), renderFinishedSemaphore, nullptr);
+    // Callers have waited for the GPU by now, so every retired swapchain can go too.
+    destroyRetired(UINT64_MAX);
+    destroyImageViews(swapchainImageViews);
 
-    Logger::getInstance().log("Vulkan Swapchain and associated resources cleaned up successfully.");
+    if (swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(device.getDevice(), swapchain, nullptr);
+        swapchain = VK_NULL_HANDLE;
+    }
+
+    VG_LOG_INFO("Vulkan Swapchain and associated resources cleaned up successfully.");
 }
 
 VkSurfaceFormatKHR VulkanSwapchain::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
-    Logger::getInstance().log("Choosing swap surface format from available formats...");
+    VG_LOG_DEBUG("Choosing swap surface format from available formats...");
     for (const auto& availableFormat : availableFormats) {
-        Logger::getInstance().log("Available format: format=" + std::to_string(availableFormat.format) + ", colorSpace=" + std::to_string(availableFormat.colorSpace));
+        VG_LOG_DEBUG("Available format: format=", availableFormat.format, ", colorSpace=", availableFormat.colorSpace);
         if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB && availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-            Logger::getInstance().log("Selected swap surface format: VK_FORMAT_B8G8R8A8_SRGB");
+            VG_LOG_INFO("Selected swap surface format: VK_FORMAT_B8G8R8A8_SRGB");
             return availableFormat;
         }
     }
 
-    Logger::getInstance().log("Fallback to first available surface format: format=" + std::to_string(availableFormats[0].format) + ", colorSpace=" + std::to_string(availableFormats[0].colorSpace));
+    VG_LOG_DEBUG("Fallback to first available surface format: format=", availableFormats[0].format, ", colorSpace=", availableFormats[0].colorSpace);
     return availableFormats[0];
 }
 
 VkPresentModeKHR VulkanSwapchain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-    Logger::getInstance().log("Choosing swap present mode from available present modes...");
+    VG_LOG_DEBUG("Choosing swap present mode from available present modes...");
     for (const auto& availablePresentMode : availablePresentModes) {
-        Logger::getInstance().log("Available present mode: " + std::to_string(availablePresentMode));
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            Logger::getInstance().log("Selected present mode: VK_PRESENT_MODE_MAILBOX_KHR");
-            return availablePresentMode;
+        VG_LOG_DEBUG("Available present mode: ", availablePresentMode);
+    }
+
+    for (VkPresentModeKHR preferred : presentModePreference(presentationPolicy)) {
+        if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preferred) != availablePresentModes.end()) {
+            return preferred;
         }
     }
 
-    Logger::getInstance().log("Using FIFO present mode as fallback: VK_PRESENT_MODE_FIFO_KHR");
+    VG_LOG_DEBUG("Using FIFO present mode as fallback: VK_PRESENT_MODE_FIFO_KHR");
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
 VkExtent2D VulkanSwapchain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
-    Logger::getInstance().log("Choosing swap extent...");
+    VG_LOG_DEBUG("Choosing swap extent...");
     if (capabilities.currentExtent.width != UINT32_MAX) {
-        Logger::getInstance().log("Using current extent: " + std::to_string(capabilities.currentExtent.width) + "x" + std::to_string(capabilities.currentExtent.height));
+        VG_LOG_DEBUG("Using current extent: ", capabilities.currentExtent.width, "x", capabilities.currentExtent.height);
         return capabilities.currentExtent;
     }
     else {
-        VkExtent2D actualExtent = { 800, 600 };
+        VkExtent2D actualExtent = desiredExtent;
         actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
         actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
-        Logger::getInstance().log("Calculated extent: " + std::to_string(actualExtent.width) + "x" + std::to_string(actualExtent.height));
+        VG_LOG_DEBUG("Calculated extent: ", actualExtent.width, "x", actualExtent.height);
         return actualExtent;
     }
 }
\ No newline at end of file
@@ -3,21 +3,48 @@
 #include "VulkanInstance.h"
 #include "VulkanDevice.h"
 #include <vector>
+#include <deque>
+#include <cstdint>
 #include <vulkan/vulkan.h>
 #include "Logger.h"
+#include "PresentationPolicy.h"
+#include "RenderTarget.h"
 
-class VulkanSwapchain {
+class VulkanSwapchain : public RenderTarget {
 public:
     VulkanSwapchain(VulkanInstance& instance, VulkanDevice& device, VkSurfaceKHR surface);
     void init();
     void cleanup();
 
+    // Builds a new swapchain for the surface's current size, handing the old one
+    // over through oldSwapchain. The old swapchain and its image views are kept
+    // alive until destroyRetired() sees retireAfterFrame complete. Returns false
+    // (and changes nothing) while the surface has a zero extent, e.g. minimized.
+    bool recreate(uint64_t retireAfterFrame) override;
+    void destroyRetired(uint64_t completedFrameNumber) override;
+
+    // RenderTarget
+    VkFormat getImageFormat() const override { return swapchainImageFormat; }
+    VkExtent2D getExtent() const override { return swapchainExtent; }
+    const std::vector<VkImageView>& getImageViews() const override { return swapchainImageViews; }
+    VkImage getImage(uint32_t imageIndex) const override { return swapchainImages[imageIndex]; }
+    VkImageLayout getFinalLayout() const override { return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
+    bool isPresentable() const override { return true; }
+    VkResult acquireNextImage(VkSemaphore imageAvailable, uint32_t& imageIndex) override;
+    VkResult present(VkQueue queue, VkSemaphore renderFinished, uint32_t imageIndex) override;
+
+    // Takes effect on the next init() or recreate().
+    void setPresentationPolicy(PresentationPolicy policy) { presentationPolicy = policy; }
+    PresentationPolicy getPresentationPolicy() const { return presentationPolicy; }
+    VkPresentModeKHR getPresentMode() const { return presentMode; }
+
+    // Used when the surface leaves the extent to the application (currentExtent == UINT32_MAX).
+    void setDesiredExtent(uint32_t width, uint32_t height) { desiredExtent = { width, height }; }
+
     VkSwapchainKHR getSwapchain() const { return swapchain; }
     VkFormat getSwapchainImageFormat() const { return swapchainImageFormat; }
     VkExtent2D getSwapchainExtent() const { return swapchainExtent; }
     std::vector<VkImageView> getSwapchainImageViews() const { return swapchainImageViews; }
-    VkSemaphore getImageAvailableSemaphore() const { return imageAvailableSemaphore; }
-    VkSemaphore getRenderFinishedSemaphore() const { return renderFinishedSemaphore; }
 
     VkRenderPass getRenderPass() const { return renderPass; }
     VkCommandBuffer getCommandBuffer() const { return commandBuffer; }
@@ -34,8 +61,16 @@ private:
     VkExtent2D swapchainExtent;
     std::vector<VkImage> swapchainImages;
     std::vector<VkImageView> swapchainImageViews;
-    VkSemaphore imageAvailableSemaphore;
-    VkSemaphore renderFinishedSemaphore;
+    VkExtent2D desiredExtent{ 800, 600 };
+    PresentationPolicy presentationPolicy = PresentationPolicy::Balanced;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+    struct RetiredSwapchain {
+        VkSwapchainKHR swapchain;
+        std::vector<VkImageView> imageViews;
+        uint64_t retireAfterFrame;
+    };
+    std::deque<RetiredSwapchain> retiredSwapchains;
 
     VkRenderPass renderPass;
     VkCommandBuffer commandBuffer;
@@ -45,6 +80,10 @@ private:
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 
+    void createSwapchain(const SwapChainSupportDetails& swapChainSupport, VkSwapchainKHR oldSwapchain);
+    void createImageViews();
+    void destroyImageViews(std::vector<VkImageView>& imageViews);
+
     void createRenderPass();  // Function to create the render pass
     void createCommandBuffer();  // Function to create the command buffer
     void createFramebuffers();  // Function to create framebuffers
@@ -0,0 +1,126 @@
+#include "GridDataStore.h"
+#include "VulkanBuffer.h"
+#include "UploadManager.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+GridDataStore::GridDataStore(uint32_t width, uint32_t height, uint32_t tileSize, float cellSpacing)
+    : width(width), height(height), tileSize(tileSize), tileMask(tileSize - 1) {
+    if (tileSize == 0 || (tileSize & (tileSize - 1)) != 0) {
+        VG_LOG_ERROR("Grid tile size ", tileSize, " is not a power of two");
+        throw std::runtime_error("Grid tile size must be a power of two!");
+    }
+    while ((1u << tileShift) < tileSize) {
+        tileShift++;
+    }
+    tilesX = (width + tileMask) >> tileShift;
+    tilesY = (height + tileMask) >> tileShift;
+
+    // Every cell sits at its own grid position; padding stays hidden.
+    cells.resize(static_cast<size_t>(tilesX) * tilesY * tileSize * tileSize);
+    for (uint32_t y = 0; y < tilesY * tileSize; y++) {
+        for (uint32_t x = 0; x < tilesX * tileSize; x++) {
+            GridInstance& cell = cells[cellIndex(x, y)];
+            cell.x = x * cellSpacing;
+            cell.y = y * cellSpacing;
+            cell.color = 0;
+            cell.state = (x < width && y < height) ? 0 : kGridCellHidden;
+        }
+    }
+
+    dirtyBits.resize((getTileCount() + 63) / 64, 0);
+    markAllDirty();
+}
+
+void GridDataStore::setCell(uint32_t x, uint32_t y, const GridInstance& cell) {
+    cells[cellIndex(x, y)] = cell;
+    markCellDirty(x, y);
+}
+
+void GridDataStore::setCellColor(uint32_t x, uint32_t y, uint32_t color) {
+    cells[cellIndex(x, y)].color = color;
+    markCellDirty(x, y);
+}
+
+void GridDataStore::setCellState(uint32_t x, uint32_t y, uint32_t state) {
+    cells[cellIndex(x, y)].state = state;
+    markCellDirty(x, y);
+}
+
+GridInstance* GridDataStore::editTile(uint32_t tileX, uint32_t tileY) {
+    uint32_t tile = tileY * tilesX + tileX;
+    markTileDirty(tile);
+    return &cells[tileFirstCell(tile)];
+}
+
+void GridDataStore::markTileDirty(uint32_t tile) {
+    uint64_t bit = 1ull << (tile & 63);
+    uint64_t& word = dirtyBits[tile >> 6];
+    if ((word & bit) == 0) {
+        word |= bit;
+        dirtyTileCount++;
+    }
+}
+
+void GridDataStore::markAllDirty() {
+    uint32_t tileCount = getTileCount();
+    for (size_t i = 0; i < dirtyBits.size(); i++) {
+        uint32_t bitsInWord = std::min<uint32_t>(64, tileCount - static_cast<uint32_t>(i * 64));
+        dirtyBits[i] = bitsInWord == 64 ? ~0ull : (1ull << bitsInWord) - 1;
+    }
+    dirtyTileCount = tileCount;
+}
+
+void GridDataStore::getDirtyTiles(std::vector<uint32_t>& tiles) const {
+    for (size_t i = 0; i < dirtyBits.size(); i++) {
+        for (uint64_t word = dirtyBits[i]; word != 0; word &= word - 1) {
+            uint32_t bit = 0;
+            while (((word >> bit) & 1) == 0) {
+                bit++;
+            }
+            tiles.push_back(static_cast<uint32_t>(i * 64 + bit));
+        }
+    }
+}
+
+VkDeviceSize GridDataStore::flush(UploadManager& uploadManager, const VulkanBuffer& dst, VkDeviceSize dstOffset) {
+    lastFlushRanges = 0;
+    if (dirtyTileCount == 0) {
+        return 0;
+    }
+    VkDeviceSize tileBytes = static_cast<VkDeviceSize>(getCellsPerTile()) * sizeof(GridInstance);
+    if (dst.getSize() < dstOffset + static_cast<VkDeviceSize>(getTileCount()) * tileBytes) {
+        VG_LOG_ERROR("Grid buffer of ", dst.getSize(), " bytes cannot hold ", getCellCount(), " cells");
+        throw std::runtime_error("Grid buffer is too small for the grid!");
+    }
+
+    // Runs of set bits become one range each; clean words are skipped 64 tiles at a time.
+    VkDeviceSize queuedBytes = 0;
+    uint32_t tileCount = getTileCount();
+    uint32_t tile = 0;
+    while (tile < tileCount) {
+        uint64_t word = dirtyBits[tile >> 6] >> (tile & 63);
+        if (word == 0) {
+            tile = (tile | 63) + 1;
+            continue;
+        }
+        while ((word & 1) == 0) {
+            word >>= 1;
+            tile++;
+        }
+        uint32_t first = tile;
+        while (tile < tileCount && isTileDirty(tile)) {
+            tile++;
+        }
+
+        VkDeviceSize bytes = (tile - first) * tileBytes;
+        uploadManager.uploadBuffer(dst.getBuffer(), dstOffset + first * tileBytes, &cells[tileFirstCell(first)], bytes);
+        queuedBytes += bytes;
+        lastFlushRanges++;
+    }
+
+    std::fill(dirtyBits.begin(), dirtyBits.end(), 0);
+    dirtyTileCount = 0;
+    return queuedBytes;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "GridTypes.h"
+
+class VulkanBuffer;
+class UploadManager;
+
+/**
+ * @brief CPU copy of a width x height grid, laid out tile by tile, that uploads only what changed.
+ *
+ * Cells are stored in tileSize x tileSize tiles, each tile contiguous, in the
+ * same order as on the GPU, so a tile is always one byte range of the
+ * instance buffer. Edits set the tile's bit in a dirty bitset; flush() walks
+ * the set bits, merges neighbouring dirty tiles into one range and hands each
+ * range to the UploadManager, which records all ranges aimed at the buffer as
+ * regions of a single vkCmdCopyBuffer. Upload traffic therefore follows the
+ * number of edited tiles, not the grid size.
+ *
+ * Edge tiles are padded to full size with kGridCellHidden cells, so the
+ * buffer holds getCellCount() >= width * height cells. Not thread-safe.
+ */
+class GridDataStore {
+public:
+    static constexpr uint32_t kDefaultTileSize = 16; // 256 cells, 4 KiB per tile
+
+    // tileSize must be a power of two. Cell (x, y) starts at world position (x, y) * cellSpacing.
+    GridDataStore(uint32_t width, uint32_t height, uint32_t tileSize = kDefaultTileSize, float cellSpacing = 1.0f);
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    uint32_t getTileSize() const { return tileSize; }
+    uint32_t getTilesX() const { return tilesX; }
+    uint32_t getTilesY() const { return tilesY; }
+    uint32_t getTileCount() const { return tilesX * tilesY; }
+    uint32_t getCellsPerTile() const { return tileSize * tileSize; }
+    // Cells in the GPU buffer, padding included.
+    uint32_t getCellCount() const { return static_cast<uint32_t>(cells.size()); }
+
+    // Index of cell (x, y) in the tile-major buffer.
+    uint32_t cellIndex(uint32_t x, uint32_t y) const {
+        uint32_t tile = (y >> tileShift) * tilesX + (x >> tileShift);
+        return (tile << (2 * tileShift)) + ((y & tileMask) << tileShift) + (x & tileMask);
+    }
+
+    const GridInstance& getCell(uint32_t x, uint32_t y) const { return cells[cellIndex(x, y)]; }
+    void setCell(uint32_t x, uint32_t y, const GridInstance& cell);
+    void setCellColor(uint32_t x, uint32_t y, uint32_t color);
+    void setCellState(uint32_t x, uint32_t y, uint32_t state);
+
+    // Direct access to one tile's getCellsPerTile() cells (row-major within the
+    // tile) for bulk edits; the tile is marked dirty.
+    GridInstance* editTile(uint32_t tileX, uint32_t tileY);
+    const GridInstance* getTile(uint32_t tileX, uint32_t tileY) const { return &cells[tileFirstCell(tileY * tilesX + tileX)]; }
+
+    void markTileDirty(uint32_t tile);
+    void markAllDirty();
+    bool isTileDirty(uint32_t tile) const { return (dirtyBits[tile >> 6] >> (tile & 63)) & 1; }
+    uint32_t getDirtyTileCount() const { return dirtyTileCount; }
+    // Appends the dirty tiles in ascending order.
+    void getDirtyTiles(std::vector<uint32_t>& tiles) const;
+
+    // Queues the dirty ranges for upload into dst, whose cells from dstOffset bytes
+    // on mirror this store, and clears the dirty set. Returns the number of bytes queued.
+    // Pass the RenderPass's UploadManager: small flushes are copied inside the next frame
+    // behind a barrier, larger ones wait on its reader timeline, so either way the copies never
+    // overwrite cells that earlier frames, or their culling dispatch, still read.
+    VkDeviceSize flush(UploadManager& uploadManager, const VulkanBuffer& dst, VkDeviceSize dstOffset = 0);
+
+    uint32_t getLastFlushRanges() const { return lastFlushRanges; }
+
+private:
+    uint32_t tileFirstCell(uint32_t tile) const { return tile << (2 * tileShift); }
+    void markCellDirty(uint32_t x, uint32_t y) { markTileDirty((y >> tileShift) * tilesX + (x >> tileShift)); }
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t tileShift = 0;
+    uint32_t tileMask;
+    uint32_t tilesX;
+    uint32_t tilesY;
+
+    std::vector<GridInstance> cells;
+    std::vector<uint64_t> dirtyBits; // One bit per tile
+    uint32_t dirtyTileCount = 0;
+    uint32_t lastFlushRanges = 0;
+};
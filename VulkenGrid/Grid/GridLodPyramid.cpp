@@ -0,0 +1,161 @@
+#include "GridLodPyramid.h"
+#include "VulkanBuffer.h"
+#include "UploadManager.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+GridLodPyramid::GridLodPyramid(uint32_t width, uint32_t height, GridLodMode mode, uint32_t tileSize, uint32_t maxLevels)
+    : mode(mode) {
+    if (tileSize < 2) {
+        VG_LOG_ERROR("Grid LOD tile size ", tileSize, " is below 2");
+        throw std::runtime_error("Grid LOD tiles must be at least 2 cells wide!");
+    }
+    // The level has to fit in kGridCellLevelMask.
+    const uint32_t levelLimit = std::min(std::max(maxLevels, 1u), (kGridCellLevelMask >> kGridCellLevelShift) + 1);
+
+    levels.push_back(std::make_unique<GridDataStore>(width, height, tileSize));
+    while (levels.size() < levelLimit) {
+        const GridDataStore& fine = *levels.back();
+        if (fine.getTilesX() <= 1 && fine.getTilesY() <= 1) {
+            break;
+        }
+        uint32_t level = static_cast<uint32_t>(levels.size());
+        levels.push_back(std::make_unique<GridDataStore>((fine.getWidth() + 1) / 2, (fine.getHeight() + 1) / 2, tileSize,
+                                                         static_cast<float>(1u << level)));
+    }
+
+    uint64_t cellCount = 0;
+    for (const auto& store : levels) {
+        levelFirstCell.push_back(static_cast<uint32_t>(cellCount));
+        cellCount += store->getCellCount();
+    }
+    if (cellCount > UINT32_MAX) {
+        VG_LOG_ERROR("Grid LOD pyramid of ", cellCount, " cells does not fit 32-bit instance indices");
+        throw std::runtime_error("Grid LOD pyramid is too large!");
+    }
+    totalCellCount = static_cast<uint32_t>(cellCount);
+    VG_LOG_DEBUG("Grid LOD pyramid: ", levels.size(), " levels, ", totalCellCount, " cells");
+}
+
+GridInstance GridLodPyramid::aggregateCell(const GridDataStore& fine, uint32_t x, uint32_t y, uint32_t level) const {
+    uint32_t channelSum[4] = { 0, 0, 0, 0 };
+    uint32_t channelMax[4] = { 0, 0, 0, 0 };
+    uint32_t states = 0;
+    uint32_t visible = 0;
+    for (uint32_t childY = y * 2; childY < std::min(y * 2 + 2, fine.getHeight()); childY++) {
+        for (uint32_t childX = x * 2; childX < std::min(x * 2 + 2, fine.getWidth()); childX++) {
+            const GridInstance& child = fine.getCell(childX, childY);
+            if (child.state & kGridCellHidden) {
+                continue;
+            }
+            for (uint32_t channel = 0; channel < 4; channel++) {
+                uint32_t value = (child.color >> (channel * 8)) & 0xFF;
+                channelSum[channel] += value;
+                channelMax[channel] = std::max(channelMax[channel], value);
+            }
+            states |= child.state;
+            visible++;
+        }
+    }
+
+    float spacing = static_cast<float>(1u << level);
+    GridInstance cell{};
+    cell.x = x * spacing;
+    cell.y = y * spacing;
+    cell.state = (states & kGridCellAppStateMask) | (level << kGridCellLevelShift);
+    if (visible == 0) {
+        cell.state |= kGridCellHidden;
+        return cell;
+    }
+    for (uint32_t channel = 0; channel < 4; channel++) {
+        uint32_t value = mode == GridLodMode::Max ? channelMax[channel] : (channelSum[channel] + visible / 2) / visible;
+        cell.color |= value << (channel * 8);
+    }
+    return cell;
+}
+
+void GridLodPyramid::aggregateTile(uint32_t level, uint32_t tile) {
+    const GridDataStore& fine = *levels[level];
+    GridDataStore& coarse = *levels[level + 1];
+    uint32_t half = fine.getTileSize() / 2;
+    uint32_t firstX = (tile % fine.getTilesX()) * half;
+    uint32_t firstY = (tile / fine.getTilesX()) * half;
+    uint32_t lastX = std::min(firstX + half, coarse.getWidth());
+    uint32_t lastY = std::min(firstY + half, coarse.getHeight());
+    for (uint32_t y = firstY; y < lastY; y++) {
+        for (uint32_t x = firstX; x < lastX; x++) {
+            coarse.setCell(x, y, aggregateCell(fine, x, y, level + 1));
+        }
+    }
+}
+
+void GridLodPyramid::update() {
+    // Level by level, so tiles dirtied in one level are folded into the next.
+    for (uint32_t level = 0; level + 1 < levels.size(); level++) {
+        dirtyTiles.clear();
+        levels[level]->getDirtyTiles(dirtyTiles);
+        for (uint32_t tile : dirtyTiles) {
+            aggregateTile(level, tile);
+        }
+    }
+}
+
+VkDeviceSize GridLodPyramid::flush(UploadManager& uploadManager, const VulkanBuffer& dst) {
+    update();
+    VkDeviceSize queuedBytes = 0;
+    for (uint32_t level = 0; level < levels.size(); level++) {
+        queuedBytes += levels[level]->flush(uploadManager, dst, static_cast<VkDeviceSize>(levelFirstCell[level]) * sizeof(GridInstance));
+    }
+    return queuedBytes;
+}
+
+uint32_t GridLodPyramid::selectLevel(float pixelsPerCell) const {
+    uint32_t level = 0;
+    while (level + 1 < levels.size() && pixelsPerCell * static_cast<float>(1u << level) < minPixelsPerCell) {
+        level++;
+    }
+    return level;
+}
+
+void GridLodPyramid::selectDraws(const GridView& view, VkExtent2D extent, std::vector<GridLodDraw>& draws) const {
+    draws.clear();
+    if (extent.width == 0 || extent.height == 0 || !(view.viewHeight > 0.0f)) {
+        return;
+    }
+    float pixelsPerUnit = extent.height / view.viewHeight;
+    uint32_t level = selectLevel(pixelsPerUnit);
+    const GridDataStore& store = *levels[level];
+    if (store.getTileCount() == 0) {
+        return;
+    }
+
+    // Cells reach up to one spacing past their position, so widen the low side by one.
+    float spacing = static_cast<float>(1u << level);
+    float tileWorldSize = store.getTileSize() * spacing;
+    float halfHeight = view.viewHeight * 0.5f;
+    float halfWidth = halfHeight * extent.width / extent.height;
+    float minTileX = std::floor((view.centerX - halfWidth - spacing) / tileWorldSize);
+    float minTileY = std::floor((view.centerY - halfHeight - spacing) / tileWorldSize);
+    float maxTileX = std::floor((view.centerX + halfWidth) / tileWorldSize);
+    float maxTileY = std::floor((view.centerY + halfHeight) / tileWorldSize);
+    if (maxTileX < 0.0f || maxTileY < 0.0f || minTileX >= store.getTilesX() || minTileY >= store.getTilesY()) {
+        return;
+    }
+    uint32_t firstTileX = static_cast<uint32_t>(std::max(minTileX, 0.0f));
+    uint32_t firstTileY = static_cast<uint32_t>(std::max(minTileY, 0.0f));
+    uint32_t lastTileX = static_cast<uint32_t>(std::min(maxTileX, static_cast<float>(store.getTilesX() - 1)));
+    uint32_t lastTileY = static_cast<uint32_t>(std::min(maxTileY, static_cast<float>(store.getTilesY() - 1)));
+
+    // Each tile row is contiguous in the buffer; rows spanning the whole grid merge into one draw.
+    uint32_t rowCells = (lastTileX - firstTileX + 1) * store.getCellsPerTile();
+    for (uint32_t tileY = firstTileY; tileY <= lastTileY; tileY++) {
+        uint32_t first = levelFirstCell[level] + (tileY * store.getTilesX() + firstTileX) * store.getCellsPerTile();
+        if (!draws.empty() && draws.back().firstInstance + draws.back().instanceCount == first) {
+            draws.back().instanceCount += rowCells;
+        } else {
+            draws.push_back({ first, rowCells });
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "GridTypes.h"
+#include "GridDataStore.h"
+
+class VulkanBuffer;
+class UploadManager;
+
+// How a coarse cell combines the (up to four) visible cells below it.
+enum class GridLodMode : uint32_t {
+    Average,  // Per-channel mean colour
+    Max       // Per-channel maximum colour, so isolated bright cells survive zooming out
+};
+
+// A contiguous run of instances to draw: a row of neighbouring tiles of one level.
+struct GridLodDraw {
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+/**
+ * @brief Mip-like pyramid of GridDataStores for drawing huge grids zoomed out.
+ *
+ * Level 0 holds the cells; each level above halves both dimensions, with
+ * coarse cell (x, y) aggregating cells (2x..2x+1, 2y..2y+1) of the level
+ * below and tagged with its level in the state bits so it is drawn twice as
+ * large. Its application state bits (0-23) are the OR of its visible children's,
+ * so a flag set on any cell stays set on every coarse cell covering it. All
+ * levels share one instance buffer, level after level.
+ *
+ * Edit level 0, then call flush(): each dirty tile is folded into the quarter
+ * tile above it, marking that tile dirty in turn, so keeping the coarse levels
+ * current costs work and uploads proportional to the edit, never a rebuild.
+ *
+ * selectDraws() picks the finest level whose cells are at least
+ * minPixelsPerCell on screen and emits only that level's tiles overlapping
+ * the view, so the instance count tracks the screen size, not the grid size.
+ * GridView is orthographic, so one level fits every tile of a frame.
+ */
+class GridLodPyramid {
+public:
+    // maxLevels caps the pyramid height; 1 gives a plain GridDataStore.
+    GridLodPyramid(uint32_t width, uint32_t height, GridLodMode mode = GridLodMode::Average,
+                   uint32_t tileSize = GridDataStore::kDefaultTileSize, uint32_t maxLevels = 16);
+
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levels.size()); }
+    GridDataStore& getLevel(uint32_t level) { return *levels[level]; }
+    const GridDataStore& getLevel(uint32_t level) const { return *levels[level]; }
+    // First instance of a level in the shared buffer.
+    uint32_t getLevelFirstCell(uint32_t level) const { return levelFirstCell[level]; }
+    // Instance buffer cells needed for every level.
+    uint32_t getTotalCellCount() const { return totalCellCount; }
+
+    void setMinPixelsPerCell(float pixels) { minPixelsPerCell = pixels; }
+    float getMinPixelsPerCell() const { return minPixelsPerCell; }
+
+    // Re-aggregates the coarse levels under dirty fine tiles.
+    void update();
+    // update(), then queues every level's dirty tiles for upload into dst. Returns the bytes queued.
+    VkDeviceSize flush(UploadManager& uploadManager, const VulkanBuffer& dst);
+
+    // Replaces draws with the tile runs to draw for view on a target of extent pixels.
+    void selectDraws(const GridView& view, VkExtent2D extent, std::vector<GridLodDraw>& draws) const;
+    // Finest level whose cells span at least minPixelsPerCell, given how many pixels one level-0 cell spans.
+    uint32_t selectLevel(float pixelsPerCell) const;
+
+private:
+    void aggregateTile(uint32_t level, uint32_t tile);
+    GridInstance aggregateCell(const GridDataStore& fine, uint32_t x, uint32_t y, uint32_t level) const;
+
+    GridLodMode mode;
+    float minPixelsPerCell = 2.0f;
+    std::vector<std::unique_ptr<GridDataStore>> levels;
+    std::vector<uint32_t> levelFirstCell;
+    uint32_t totalCellCount = 0;
+    std::vector<uint32_t> dirtyTiles; // Scratch for update()
+};
@@ -0,0 +1,460 @@
+#include "GridRenderer.h"
+#include "VulkanDevice.h"
+#include "RenderPass.h"
+#include "UploadManager.h"
+#include "PipelineCache.h"
+#include "PipelineLibrary.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+GridRenderer::GridRenderer(VulkanDevice& device, RenderPass& renderPass, UploadManager& uploadManager, PipelineCache* pipelineCache,
+                           PipelineLibrary* pipelineLibrary)
+    : device(device), renderPass(renderPass), uploadManager(uploadManager), pipelineCache(pipelineCache), pipelineLibrary(pipelineLibrary),
+      instanceBuffer(device), indexBuffer(device), visibleBuffer(device), culledIndirectBuffer(device),
+      cullPipeline(device, pipelineCache) {}
+
+GridRenderer::~GridRenderer() {
+    cleanup();
+}
+
+void GridRenderer::init(uint32_t maxInstanceCount) {
+    VG_LOG_INFO("Initializing grid renderer for up to ", maxInstanceCount, " cells...");
+    maxInstances = std::max(maxInstanceCount, 1u);
+
+    // Cells and visible cells are bound with VK_WHOLE_SIZE, so each must fit one storage range.
+    VkDeviceSize maxRange = device.getProperties().limits.maxStorageBufferRange;
+    if (static_cast<VkDeviceSize>(maxInstances) * sizeof(GridInstance) > maxRange) {
+        VG_LOG_ERROR("Grid of ", maxInstances, " cells needs ", static_cast<VkDeviceSize>(maxInstances) * sizeof(GridInstance),
+                     " bytes of storage buffer, but the device binds at most ", maxRange, " (", maxRange / sizeof(GridInstance), " cells)");
+        throw std::runtime_error("Grid exceeds the device's storage buffer range!");
+    }
+
+    instanceBuffer.createBuffer(static_cast<VkDeviceSize>(maxInstances) * sizeof(GridInstance),
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::GpuOnly);
+    indexBuffer.createBuffer(6 * sizeof(uint16_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             MemoryUsage::GpuOnly);
+    visibleBuffer.createBuffer(static_cast<VkDeviceSize>(maxInstances) * sizeof(GridInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               MemoryUsage::GpuOnly);
+    culledIndirectBuffer.createBuffer(sizeof(VkDrawIndexedIndirectCommand),
+                                      VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      MemoryUsage::GpuOnly);
+
+    // Two triangles sharing the 1-2 edge; grid.vert turns the index into a corner.
+    const uint16_t indices[6] = { 0, 1, 2, 2, 1, 3 };
+    uploadManager.uploadBuffer(indexBuffer.getBuffer(), 0, indices, sizeof(indices));
+    instanceCount = 0;
+
+    // Only the instance count changes from here on; the culling pass rewrites it every frame.
+    VkDrawIndexedIndirectCommand culledCommand{};
+    culledCommand.indexCount = 6;
+    uploadManager.uploadBuffer(culledIndirectBuffer.getBuffer(), 0, &culledCommand, sizeof(culledCommand));
+
+    createDescriptors();
+    createPipeline();
+    createCommandBuffers();
+    VG_LOG_INFO("Grid renderer initialized.");
+}
+
+void GridRenderer::cleanup() {
+    if (descriptorPool == VK_NULL_HANDLE) {
+        return;
+    }
+    // Callers have waited for the GPU by now.
+    VkDevice logicalDevice = device.getDevice();
+    vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+    commandPool = VK_NULL_HANDLE;
+    commandBuffers.clear();
+    cullCommandBuffers.clear();
+    cullPipeline.cleanup();
+    // The library's pipeline is keyed by the layout, so it goes with it.
+    if (pipelineHandle.isValid()) {
+        pipelineLibrary->release(pipelineLayout);
+        pipelineHandle = PipelineHandle();
+    }
+    framePipeline = VK_NULL_HANDLE;
+    vkDestroyPipeline(logicalDevice, pipeline, nullptr);
+    pipeline = VK_NULL_HANDLE;
+    vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
+    pipelineLayout = VK_NULL_HANDLE;
+    vkDestroyDescriptorPool(logicalDevice, descriptorPool, nullptr);
+    descriptorPool = VK_NULL_HANDLE;
+    allCellsSet = VK_NULL_HANDLE;
+    visibleCellsSet = VK_NULL_HANDLE;
+    cullSet = VK_NULL_HANDLE;
+    vkDestroyDescriptorSetLayout(logicalDevice, cullSetLayout, nullptr);
+    cullSetLayout = VK_NULL_HANDLE;
+    vkDestroyDescriptorSetLayout(logicalDevice, descriptorSetLayout, nullptr);
+    descriptorSetLayout = VK_NULL_HANDLE;
+
+    culledIndirectBuffer.cleanup();
+    visibleBuffer.cleanup();
+    indexBuffer.cleanup();
+    instanceBuffer.cleanup();
+    VG_LOG_INFO("Grid renderer destroyed.");
+}
+
+void GridRenderer::setInstances(const GridInstance* instances, uint32_t count) {
+    if (count > maxInstances) {
+        VG_LOG_ERROR("Grid of ", count, " cells exceeds the renderer's capacity of ", maxInstances);
+        throw std::runtime_error("Grid exceeds the renderer's capacity!");
+    }
+    if (count > 0) {
+        uploadManager.uploadBuffer(instanceBuffer.getBuffer(), 0, instances, static_cast<VkDeviceSize>(count) * sizeof(GridInstance));
+    }
+    setInstanceCount(count);
+}
+
+void GridRenderer::setInstanceCount(uint32_t count) {
+    if (count > maxInstances) {
+        VG_LOG_ERROR("Grid of ", count, " cells exceeds the renderer's capacity of ", maxInstances);
+        throw std::runtime_error("Grid exceeds the renderer's capacity!");
+    }
+    // The draw itself is written per frame by prepareDraws().
+    instanceCount = count;
+}
+
+void GridRenderer::setLodPyramid(const GridLodPyramid* pyramid) {
+    if (pyramid && pyramid->getTotalCellCount() > maxInstances) {
+        VG_LOG_ERROR("Grid LOD pyramid of ", pyramid->getTotalCellCount(), " cells exceeds the renderer's capacity of ", maxInstances);
+        throw std::runtime_error("Grid LOD pyramid exceeds the renderer's capacity!");
+    }
+    lodPyramid = pyramid;
+}
+
+void GridRenderer::updateInstances(uint32_t first, const GridInstance* instances, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (first > instanceCount || count > instanceCount - first) {
+        VG_LOG_ERROR("Grid update [", first, ", ", first + count, ") is outside the grid of ", instanceCount, " cells");
+        throw std::runtime_error("Grid update is outside the grid!");
+    }
+    uploadManager.uploadBuffer(instanceBuffer.getBuffer(), static_cast<VkDeviceSize>(first) * sizeof(GridInstance), instances,
+                               static_cast<VkDeviceSize>(count) * sizeof(GridInstance));
+}
+
+void GridRenderer::createDescriptors() {
+    // Graphics: the cells to draw. Culling: all cells in, visible cells and the draw out.
+    VkDescriptorSetLayoutBinding cellBinding{};
+    cellBinding.binding = 0;
+    cellBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    cellBinding.descriptorCount = 1;
+    cellBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &cellBinding;
+
+    VkResult result = vkCreateDescriptorSetLayout(device.getDevice(), &layoutInfo, nullptr, &descriptorSetLayout);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create grid descriptor set layout. VkResult: ", result);
+        throw std::runtime_error("Failed to create grid descriptor set layout!");
+    }
+
+    VkDescriptorSetLayoutBinding cullBindings[3]{};
+    for (uint32_t i = 0; i < 3; i++) {
+        cullBindings[i].binding = i;
+        cullBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        cullBindings[i].descriptorCount = 1;
+        cullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = cullBindings;
+
+    result = vkCreateDescriptorSetLayout(device.getDevice(), &layoutInfo, nullptr, &cullSetLayout);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create grid culling descriptor set layout. VkResult: ", result);
+        throw std::runtime_error("Failed to create grid culling descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 5;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 3;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    result = vkCreateDescriptorPool(device.getDevice(), &poolInfo, nullptr, &descriptorPool);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create grid descriptor pool. VkResult: ", result);
+        throw std::runtime_error("Failed to create grid descriptor pool!");
+    }
+
+    VkDescriptorSetLayout setLayouts[3] = { descriptorSetLayout, descriptorSetLayout, cullSetLayout };
+    VkDescriptorSet sets[3];
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 3;
+    allocInfo.pSetLayouts = setLayouts;
+
+    result = vkAllocateDescriptorSets(device.getDevice(), &allocInfo, sets);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate grid descriptor sets. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate grid descriptor sets!");
+    }
+    allCellsSet = sets[0];
+    visibleCellsSet = sets[1];
+    cullSet = sets[2];
+
+    // The buffers never change, so the sets are written once.
+    struct SetBinding {
+        VkDescriptorSet set;
+        uint32_t binding;
+        VkBuffer buffer;
+    };
+    const SetBinding bindings[5] = {
+        { allCellsSet, 0, instanceBuffer.getBuffer() },
+        { visibleCellsSet, 0, visibleBuffer.getBuffer() },
+        { cullSet, 0, instanceBuffer.getBuffer() },
+        { cullSet, 1, visibleBuffer.getBuffer() },
+        { cullSet, 2, culledIndirectBuffer.getBuffer() },
+    };
+    VkDescriptorBufferInfo bufferInfos[5]{};
+    VkWriteDescriptorSet writes[5]{};
+    for (uint32_t i = 0; i < 5; i++) {
+        bufferInfos[i].buffer = bindings[i].buffer;
+        bufferInfos[i].offset = 0;
+        bufferInfos[i].range = VK_WHOLE_SIZE;
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = bindings[i].set;
+        writes[i].dstBinding = bindings[i].binding;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device.getDevice(), 5, writes, 0, nullptr);
+}
+
+void GridRenderer::createPipeline() {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GridPushConstants);
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &descriptorSetLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VkResult result = vkCreatePipelineLayout(device.getDevice(), &layoutInfo, nullptr, &pipelineLayout);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create grid pipeline layout. VkResult: ", result);
+        throw std::runtime_error("Failed to create grid pipeline layout!");
+    }
+
+    GraphicsPipelineDesc desc;
+    desc.shaders = {
+        { VK_SHADER_STAGE_VERTEX_BIT, "shaders/grid.vert.spv" },
+        { VK_SHADER_STAGE_FRAGMENT_BIT, "shaders/grid.frag.spv" }
+    };
+    desc.cullMode = VK_CULL_MODE_NONE; // Quads are drawn from either side
+    desc.layout = pipelineLayout;
+    desc.renderPass = renderPass.getRenderPass();
+    if (pipelineLibrary) {
+        pipelineHandle = pipelineLibrary->request(desc);
+    } else {
+        pipeline = PipelineLibrary::compile(device, pipelineCache ? pipelineCache->getCache() : VK_NULL_HANDLE, desc);
+    }
+
+    cullPipeline.create("shaders/grid_cull.comp.spv", { cullSetLayout }, sizeof(GridCullPushConstants));
+}
+
+void GridRenderer::createCommandBuffers() {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = device.getQueueFamilyIndices().graphicsFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    VkResult result = vkCreateCommandPool(device.getDevice(), &poolInfo, nullptr, &commandPool);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create grid command pool. VkResult: ", result);
+        throw std::runtime_error("Failed to create grid command pool!");
+    }
+
+    uint32_t framesInFlight = renderPass.getFrameRing().getFramesInFlight();
+    commandBuffers.resize(framesInFlight);
+    cullCommandBuffers.resize(framesInFlight);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+    result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate grid command buffers. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate grid command buffers!");
+    }
+
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, cullCommandBuffers.data());
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate grid culling command buffers. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate grid culling command buffers!");
+    }
+}
+
+static float aspectRatio(VkExtent2D extent) {
+    return extent.height > 0 ? static_cast<float>(extent.width) / extent.height : 1.0f;
+}
+
+GridPushConstants GridRenderer::computePushConstants() const {
+    GridPushConstants constants{};
+    // Vulkan clip space has +y pointing down; flip so world +y is up.
+    constants.scale[1] = -2.0f / std::max(view.viewHeight, 1e-6f);
+    constants.scale[0] = -constants.scale[1] / aspectRatio(renderPass.getExtent());
+    constants.offset[0] = -view.centerX * constants.scale[0];
+    constants.offset[1] = -view.centerY * constants.scale[1];
+    constants.cellSize = cellSize;
+    return constants;
+}
+
+GridCullPushConstants GridRenderer::computeCullPushConstants() const {
+    float halfHeight = view.viewHeight * 0.5f;
+    float halfWidth = halfHeight * aspectRatio(renderPass.getExtent());
+
+    GridCullPushConstants constants{};
+    constants.viewMin[0] = view.centerX - halfWidth;
+    constants.viewMin[1] = view.centerY - halfHeight;
+    constants.viewMax[0] = view.centerX + halfWidth;
+    constants.viewMax[1] = view.centerY + halfHeight;
+    constants.cellSize = cellSize;
+    constants.count = instanceCount;
+    return constants;
+}
+
+VkCommandBuffer GridRenderer::recordCulling(FrameContext& frame) {
+    // Nothing would draw the culled cells before the graphics pipeline is ready.
+    VkPipeline graphicsPipeline = pipelineLibrary ? pipelineHandle.getOr(VK_NULL_HANDLE) : pipeline;
+    if (!cullingEnabled || lodPyramid || instanceCount == 0 || graphicsPipeline == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    VkCommandBuffer commandBuffer = cullCommandBuffers[frame.index % cullCommandBuffers.size()];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin grid culling command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin grid culling command buffer!");
+    }
+
+    // The outputs are shared by all frame slots: wait for earlier frames' draws
+    // (same queue, so this covers them) before clearing the count and overwriting cells.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+    vkCmdFillBuffer(commandBuffer, culledIndirectBuffer.getBuffer(), offsetof(VkDrawIndexedIndirectCommand, instanceCount),
+                    sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0,
+                         nullptr, 0, nullptr);
+
+    GridCullPushConstants constants = computeCullPushConstants();
+    cullPipeline.bind(commandBuffer);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline.getLayout(), 0, 1, &cullSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, cullPipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    cullPipeline.dispatch(commandBuffer, instanceCount, kCullGroupSize);
+
+    VkMemoryBarrier cullBarrier{};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &cullBarrier, 0, nullptr,
+                         0, nullptr);
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record grid culling command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record grid culling command buffer!");
+    }
+    return commandBuffer;
+}
+
+size_t GridRenderer::prepareDraws(FrameContext& frame) {
+    // Picked once per frame so a compile finishing mid-frame cannot split the draws.
+    framePipeline = pipelineLibrary ? pipelineHandle.getOr(VK_NULL_HANDLE) : pipeline;
+    if (framePipeline == VK_NULL_HANDLE) {
+        return 0;
+    }
+    if (lodPyramid) {
+        lodPyramid->selectDraws(view, renderPass.getExtent(), lodDraws);
+        return lodDraws.size();
+    }
+    if (instanceCount == 0) {
+        return 0;
+    }
+    // The culling pass writes its own draw; otherwise this frame's goes through the
+    // ring, so a new count never overwrites a command an earlier frame still reads.
+    if (!cullingEnabled) {
+        VkDrawIndexedIndirectCommand command{};
+        command.indexCount = 6;
+        command.instanceCount = instanceCount;
+        drawCommand = renderPass.getDynamicBuffer().push(&command, 1);
+    }
+    return 1;
+}
+
+void GridRenderer::recordDraws(VkCommandBuffer commandBuffer, size_t begin, size_t end) const {
+    GridPushConstants constants = computePushConstants();
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, framePipeline);
+    renderPass.setViewportAndScissor(commandBuffer);
+    VkDescriptorSet cellSet = (cullingEnabled && !lodPyramid) ? visibleCellsSet : allCellsSet;
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &cellSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    if (lodPyramid) {
+        // The shader fetches cells by gl_InstanceIndex, which includes firstInstance.
+        for (size_t i = begin; i < end; i++) {
+            vkCmdDrawIndexed(commandBuffer, 6, lodDraws[i].instanceCount, 0, 0, lodDraws[i].firstInstance);
+        }
+    } else if (cullingEnabled) {
+        vkCmdDrawIndexedIndirect(commandBuffer, culledIndirectBuffer.getBuffer(), 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+    } else {
+        vkCmdDrawIndexedIndirect(commandBuffer, drawCommand.buffer, drawCommand.offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+void GridRenderer::record(FrameContext& frame, const VkCommandBufferInheritanceInfo& inheritance, std::vector<VkCommandBuffer>& secondaries) {
+    size_t drawCount = prepareDraws(frame);
+    if (drawCount == 0) {
+        return;
+    }
+    // The slot's fence has signalled, so its previous recording is no longer in use.
+    VkCommandBuffer commandBuffer = commandBuffers[frame.index % commandBuffers.size()];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin grid command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin grid command buffer!");
+    }
+
+    recordDraws(commandBuffer, 0, drawCount);
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record grid command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record grid command buffer!");
+    }
+    secondaries.push_back(commandBuffer);
+}
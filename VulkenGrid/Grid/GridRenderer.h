@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "GridTypes.h"
+#include "GridLodPyramid.h"
+#include "VulkanBuffer.h"
+#include "DynamicRingBuffer.h"
+#include "FrameContext.h"
+#include "ComputePipeline.h"
+#include "PipelineLibrary.h"
+
+class VulkanDevice;
+class RenderPass;
+class UploadManager;
+class PipelineCache;
+
+/**
+ * @brief Draws up to maxInstances grid cells with one indexed indirect draw.
+ *
+ * Cells live in a device-local storage buffer that the vertex shader indexes
+ * by gl_InstanceIndex; the quad comes from a six-index buffer and the instance
+ * count from an indirect command that each frame writes into the RenderPass's
+ * dynamic ring buffer. Recording a frame is therefore the same
+ * handful of commands whatever the cell count, and changing cells only costs
+ * the upload of the changed range.
+ *
+ * With culling enabled (the default) a compute pass before the render pass
+ * tests every cell against the view rectangle and compacts the visible ones
+ * into a second storage buffer, counting them into the indirect draw with one
+ * atomic per workgroup, so off-screen cells are never shaded.
+ *
+ * With a GridLodPyramid set, the instance buffer holds all its levels and
+ * each frame draws the pyramid's selection for the view instead: one direct
+ * draw per run of visible tiles, at a level matched to the zoom. The cell-level
+ * culling pass is skipped, since whole tiles are already culled on the CPU.
+ *
+ * Data goes through the UploadManager, which the RenderPass must also use so
+ * frames wait for the copies and the copies wait for earlier frames' reads.
+ *
+ * The storage buffers are bound whole, so maxInstances is limited by the
+ * device's maxStorageBufferRange; init() throws beyond it.
+ */
+class GridRenderer {
+public:
+    static constexpr uint32_t kCullGroupSize = 64; // local_size_x of grid_cull.comp
+
+    // With a library the graphics pipeline compiles off the render thread; nothing is drawn until it is ready.
+    GridRenderer(VulkanDevice& device, RenderPass& renderPass, UploadManager& uploadManager, PipelineCache* pipelineCache = nullptr,
+                 PipelineLibrary* pipelineLibrary = nullptr);
+    ~GridRenderer();
+
+    void init(uint32_t maxInstances);
+    void cleanup();
+
+    // Replaces the grid with count cells.
+    void setInstances(const GridInstance* instances, uint32_t count);
+    // Draws the first count cells of the instance buffer as they are; for callers
+    // that write the buffer themselves, e.g. GridDataStore.
+    void setInstanceCount(uint32_t count);
+    // Rewrites cells [first, first + count) of the current grid.
+    void updateInstances(uint32_t first, const GridInstance* instances, uint32_t count);
+
+    void setView(const GridView& newView) { view = newView; }
+    const GridView& getView() const { return view; }
+    void setCellSize(float size) { cellSize = size; }
+    void setCullingEnabled(bool enabled) { cullingEnabled = enabled; }
+    bool isCullingEnabled() const { return cullingEnabled; }
+    // Draws the pyramid's levels from the instance buffer, which the caller fills with
+    // GridLodPyramid::flush(); nullptr goes back to drawing getInstanceCount() cells.
+    void setLodPyramid(const GridLodPyramid* pyramid);
+
+    // RenderPass pre-pass callback: the culling dispatch, or VK_NULL_HANDLE when culling is off.
+    VkCommandBuffer recordCulling(FrameContext& frame);
+    // RenderPass draw list callbacks: prepareDraws() picks this frame's draws and
+    // returns how many there are; recordDraws() records draws [begin, end) into a
+    // begun secondary and may run on several threads at once.
+    size_t prepareDraws(FrameContext& frame);
+    void recordDraws(VkCommandBuffer commandBuffer, size_t begin, size_t end) const;
+    // RenderPass dynamic content callback, for passes without a job system: appends
+    // one secondary with all of this frame's draws.
+    void record(FrameContext& frame, const VkCommandBufferInheritanceInfo& inheritance, std::vector<VkCommandBuffer>& secondaries);
+
+    VkBuffer getInstanceBuffer() const { return instanceBuffer.getBuffer(); }
+    const VulkanBuffer& getInstanceStorage() const { return instanceBuffer; }
+    uint32_t getInstanceCount() const { return instanceCount; }
+    uint32_t getMaxInstances() const { return maxInstances; }
+
+private:
+    void createDescriptors();
+    void createPipeline();
+    void createCommandBuffers();
+    GridPushConstants computePushConstants() const;
+    GridCullPushConstants computeCullPushConstants() const;
+
+    VulkanDevice& device;
+    RenderPass& renderPass;
+    UploadManager& uploadManager;
+    PipelineCache* pipelineCache;
+    PipelineLibrary* pipelineLibrary;
+
+    uint32_t maxInstances = 0;
+    uint32_t instanceCount = 0;
+    GridView view;
+    float cellSize = 1.0f;
+    bool cullingEnabled = true;
+    const GridLodPyramid* lodPyramid = nullptr;
+    std::vector<GridLodDraw> lodDraws; // This frame's draws, from prepareDraws()
+    RingAllocation drawCommand;        // This frame's all-cells draw, from prepareDraws()
+
+    VulkanBuffer instanceBuffer;
+    VulkanBuffer indexBuffer;
+    VulkanBuffer visibleBuffer;         // Cells that survived culling, compacted
+    VulkanBuffer culledIndirectBuffer;  // Draws visibleBuffer; instance count written by grid_cull.comp
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet allCellsSet = VK_NULL_HANDLE;
+    VkDescriptorSet visibleCellsSet = VK_NULL_HANDLE;
+    VkDescriptorSet cullSet = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE; // Owned, without a library
+    PipelineHandle pipelineHandle;        // Library-owned
+    VkPipeline framePipeline = VK_NULL_HANDLE; // What this frame draws with, from prepareDraws()
+    ComputePipeline cullPipeline;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> commandBuffers;      // One secondary per frame slot
+    std::vector<VkCommandBuffer> cullCommandBuffers;  // One primary per frame slot
+};
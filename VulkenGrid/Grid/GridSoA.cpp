@@ -0,0 +1,383 @@
+#include "GridSoA.h"
+#include "GridDataStore.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+// Each kernel has a scalar version plus SSE2 and AVX2 versions compiled for
+// their instruction set with target attributes, so the rest of the engine
+// keeps the baseline flags and the choice is made at runtime.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VG_GRID_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VG_TARGET_SSE2
+#define VG_TARGET_AVX2
+#else
+#define VG_TARGET_SSE2 __attribute__((target("sse2")))
+#define VG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define VG_GRID_SIMD 0
+#endif
+
+namespace {
+
+// Whole-array kernels run over the padded length so they never need a tail.
+constexpr size_t kPadCells = GridSoA::kAlignment / sizeof(float);
+
+size_t paddedCount(size_t count) {
+    return (count + kPadCells - 1) / kPadCells * kPadCells;
+}
+
+// --- Scalar ---------------------------------------------------------------
+
+void translateScalar(float* x, float* y, size_t count, float dx, float dy) {
+    for (size_t i = 0; i < count; i++) {
+        x[i] += dx;
+        y[i] += dy;
+    }
+}
+
+// Channels are scaled two at a time: 16 bits per channel leave room for the product.
+inline uint32_t fadeColor(uint32_t color, uint32_t factor) {
+    uint32_t low = (((color & 0x00FF00FFu) * factor) >> 8) & 0x00FF00FFu;
+    uint32_t high = (((color >> 8) & 0x00FF00FFu) * factor) & 0xFF00FF00u;
+    return low | high;
+}
+
+void fadeScalar(uint32_t* colors, size_t count, uint32_t factor) {
+    for (size_t i = 0; i < count; i++) {
+        colors[i] = fadeColor(colors[i], factor);
+    }
+}
+
+void updateStatesScalar(uint32_t* states, size_t count, uint32_t andMask, uint32_t orMask) {
+    for (size_t i = 0; i < count; i++) {
+        states[i] = (states[i] & andMask) | orMask;
+    }
+}
+
+void packScalar(const float* x, const float* y, const uint32_t* colors, const uint32_t* states, size_t count, GridInstance* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i].x = x[i];
+        out[i].y = y[i];
+        out[i].color = colors[i];
+        out[i].state = states[i];
+    }
+}
+
+#if VG_GRID_SIMD
+
+// --- SSE2 -----------------------------------------------------------------
+
+VG_TARGET_SSE2 void translateSSE2(float* x, float* y, size_t count, float dx, float dy) {
+    const __m128 offsetX = _mm_set1_ps(dx);
+    const __m128 offsetY = _mm_set1_ps(dy);
+    for (size_t i = 0; i < count; i += 4) {
+        _mm_store_ps(x + i, _mm_add_ps(_mm_load_ps(x + i), offsetX));
+        _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i), offsetY));
+    }
+}
+
+VG_TARGET_SSE2 void fadeSSE2(uint32_t* colors, size_t count, uint32_t factor) {
+    const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+    const __m128i highMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i scale = _mm_set1_epi16(static_cast<short>(factor));
+    for (size_t i = 0; i < count; i += 4) {
+        __m128i color = _mm_load_si128(reinterpret_cast<const __m128i*>(colors + i));
+        __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(color, mask), scale), 8);
+        __m128i high = _mm_and_si128(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(color, 8), mask), scale), highMask);
+        _mm_store_si128(reinterpret_cast<__m128i*>(colors + i), _mm_or_si128(low, high));
+    }
+}
+
+VG_TARGET_SSE2 void updateStatesSSE2(uint32_t* states, size_t count, uint32_t andMask, uint32_t orMask) {
+    const __m128i andBits = _mm_set1_epi32(static_cast<int>(andMask));
+    const __m128i orBits = _mm_set1_epi32(static_cast<int>(orMask));
+    for (size_t i = 0; i < count; i += 4) {
+        __m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(states + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(states + i), _mm_or_si128(_mm_and_si128(value, andBits), orBits));
+    }
+}
+
+// 4x4 transpose of (x, y, color, state) into four GridInstances; integers ride along as float bits.
+VG_TARGET_SSE2 void packSSE2(const float* x, const float* y, const uint32_t* colors, const uint32_t* states, size_t count,
+                             GridInstance* out) {
+    size_t i = 0;
+    float* dst = reinterpret_cast<float*>(out);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vc = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + i)));
+        __m128 vs = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(states + i)));
+        __m128 xy01 = _mm_unpacklo_ps(vx, vy);
+        __m128 xy23 = _mm_unpackhi_ps(vx, vy);
+        __m128 cs01 = _mm_unpacklo_ps(vc, vs);
+        __m128 cs23 = _mm_unpackhi_ps(vc, vs);
+        _mm_storeu_ps(dst + i * 4 + 0, _mm_movelh_ps(xy01, cs01));
+        _mm_storeu_ps(dst + i * 4 + 4, _mm_movehl_ps(cs01, xy01));
+        _mm_storeu_ps(dst + i * 4 + 8, _mm_movelh_ps(xy23, cs23));
+        _mm_storeu_ps(dst + i * 4 + 12, _mm_movehl_ps(cs23, xy23));
+    }
+    packScalar(x + i, y + i, colors + i, states + i, count - i, out + i);
+}
+
+// --- AVX2 -----------------------------------------------------------------
+
+VG_TARGET_AVX2 void translateAVX2(float* x, float* y, size_t count, float dx, float dy) {
+    const __m256 offsetX = _mm256_set1_ps(dx);
+    const __m256 offsetY = _mm256_set1_ps(dy);
+    for (size_t i = 0; i < count; i += 8) {
+        _mm256_store_ps(x + i, _mm256_add_ps(_mm256_load_ps(x + i), offsetX));
+        _mm256_store_ps(y + i, _mm256_add_ps(_mm256_load_ps(y + i), offsetY));
+    }
+}
+
+VG_TARGET_AVX2 void fadeAVX2(uint32_t* colors, size_t count, uint32_t factor) {
+    const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i highMask = _mm256_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m256i scale = _mm256_set1_epi16(static_cast<short>(factor));
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i color = _mm256_load_si256(reinterpret_cast<const __m256i*>(colors + i));
+        __m256i low = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_and_si256(color, mask), scale), 8);
+        __m256i high = _mm256_and_si256(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(color, 8), mask), scale), highMask);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(colors + i), _mm256_or_si256(low, high));
+    }
+}
+
+VG_TARGET_AVX2 void updateStatesAVX2(uint32_t* states, size_t count, uint32_t andMask, uint32_t orMask) {
+    const __m256i andBits = _mm256_set1_epi32(static_cast<int>(andMask));
+    const __m256i orBits = _mm256_set1_epi32(static_cast<int>(orMask));
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i value = _mm256_load_si256(reinterpret_cast<const __m256i*>(states + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(states + i), _mm256_or_si256(_mm256_and_si256(value, andBits), orBits));
+    }
+}
+
+// Same transpose as packSSE2, done per 128-bit lane, then the lanes are regrouped into cell pairs.
+VG_TARGET_AVX2 void packAVX2(const float* x, const float* y, const uint32_t* colors, const uint32_t* states, size_t count,
+                             GridInstance* out) {
+    size_t i = 0;
+    float* dst = reinterpret_cast<float*>(out);
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vc = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(colors + i)));
+        __m256 vs = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(states + i)));
+        __m256 xyLow = _mm256_unpacklo_ps(vx, vy);   // Cells 0, 1 | 4, 5
+        __m256 xyHigh = _mm256_unpackhi_ps(vx, vy);  // Cells 2, 3 | 6, 7
+        __m256 csLow = _mm256_unpacklo_ps(vc, vs);
+        __m256 csHigh = _mm256_unpackhi_ps(vc, vs);
+        __m256 cell04 = _mm256_shuffle_ps(xyLow, csLow, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 cell15 = _mm256_shuffle_ps(xyLow, csLow, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 cell26 = _mm256_shuffle_ps(xyHigh, csHigh, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 cell37 = _mm256_shuffle_ps(xyHigh, csHigh, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_storeu_ps(dst + i * 4 + 0, _mm256_permute2f128_ps(cell04, cell15, 0x20));
+        _mm256_storeu_ps(dst + i * 4 + 8, _mm256_permute2f128_ps(cell26, cell37, 0x20));
+        _mm256_storeu_ps(dst + i * 4 + 16, _mm256_permute2f128_ps(cell04, cell15, 0x31));
+        _mm256_storeu_ps(dst + i * 4 + 24, _mm256_permute2f128_ps(cell26, cell37, 0x31));
+    }
+    packScalar(x + i, y + i, colors + i, states + i, count - i, out + i);
+}
+
+#endif // VG_GRID_SIMD
+
+GridSimdLevel detectHardwareLevel() {
+#if VG_GRID_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    if (osAvx && maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 5)) != 0) {
+            return GridSimdLevel::AVX2;
+        }
+    }
+    return sse2 ? GridSimdLevel::SSE2 : GridSimdLevel::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return GridSimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return GridSimdLevel::SSE2;
+    }
+#endif
+#endif
+    return GridSimdLevel::Scalar;
+}
+
+} // namespace
+
+const char* gridSimdLevelName(GridSimdLevel level) {
+    switch (level) {
+    case GridSimdLevel::Scalar:
+        return "scalar";
+    case GridSimdLevel::SSE2:
+        return "sse2";
+    case GridSimdLevel::AVX2:
+        return "avx2";
+    default:
+        return "unknown";
+    }
+}
+
+GridSimdLevel detectGridSimdLevel() {
+    // VULKANGRID_SIMD=scalar|sse2|avx2 caps the level, e.g. to compare kernels.
+    static const GridSimdLevel level = [] {
+        GridSimdLevel detected = detectHardwareLevel();
+        if (const char* value = std::getenv("VULKANGRID_SIMD")) {
+            const std::string name = value;
+            for (GridSimdLevel candidate : { GridSimdLevel::Scalar, GridSimdLevel::SSE2, GridSimdLevel::AVX2 }) {
+                if (name == gridSimdLevelName(candidate)) {
+                    detected = std::min(detected, candidate);
+                }
+            }
+        }
+        VG_LOG_INFO("Grid kernels use ", gridSimdLevelName(detected));
+        return detected;
+    }();
+    return level;
+}
+
+void GridSoA::AlignedDelete::operator()(void* pointer) const {
+    ::operator delete(pointer, std::align_val_t(kAlignment));
+}
+
+template <typename T>
+GridSoA::AlignedArray<T> GridSoA::allocate(size_t count) {
+    size_t bytes = paddedCount(count) * sizeof(T);
+    void* memory = ::operator new(bytes, std::align_val_t(kAlignment));
+    std::memset(memory, 0, bytes);
+    return AlignedArray<T>(static_cast<T*>(memory));
+}
+
+GridSoA::GridSoA(uint32_t width, uint32_t height)
+    : width(width), height(height), cellCount(static_cast<size_t>(width) * height), simdLevel(detectGridSimdLevel()),
+      posX(allocate<float>(cellCount)), posY(allocate<float>(cellCount)), color(allocate<uint32_t>(cellCount)),
+      state(allocate<uint32_t>(cellCount)) {
+    // Every cell starts at its own grid position.
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            posX[cellIndex(x, y)] = static_cast<float>(x);
+            posY[cellIndex(x, y)] = static_cast<float>(y);
+        }
+    }
+}
+
+void GridSoA::setSimdLevel(GridSimdLevel level) {
+    simdLevel = std::min(level, detectGridSimdLevel());
+}
+
+void GridSoA::translate(float dx, float dy) {
+    size_t count = paddedCount(cellCount);
+    switch (simdLevel) {
+#if VG_GRID_SIMD
+    case GridSimdLevel::AVX2:
+        translateAVX2(posX.get(), posY.get(), count, dx, dy);
+        break;
+    case GridSimdLevel::SSE2:
+        translateSSE2(posX.get(), posY.get(), count, dx, dy);
+        break;
+#endif
+    default:
+        translateScalar(posX.get(), posY.get(), count, dx, dy);
+        break;
+    }
+}
+
+void GridSoA::fadeColors(uint32_t factor) {
+    if (factor > 256) {
+        VG_LOG_ERROR("Colour fade factor ", factor, " is above 256");
+        throw std::runtime_error("Colour fade factor must be at most 256!");
+    }
+    size_t count = paddedCount(cellCount);
+    switch (simdLevel) {
+#if VG_GRID_SIMD
+    case GridSimdLevel::AVX2:
+        fadeAVX2(color.get(), count, factor);
+        break;
+    case GridSimdLevel::SSE2:
+        fadeSSE2(color.get(), count, factor);
+        break;
+#endif
+    default:
+        fadeScalar(color.get(), count, factor);
+        break;
+    }
+}
+
+void GridSoA::fillColor(uint32_t value) {
+    std::fill(color.get(), color.get() + cellCount, value);
+}
+
+void GridSoA::updateStates(uint32_t andMask, uint32_t orMask) {
+    size_t count = paddedCount(cellCount);
+    switch (simdLevel) {
+#if VG_GRID_SIMD
+    case GridSimdLevel::AVX2:
+        updateStatesAVX2(state.get(), count, andMask, orMask);
+        break;
+    case GridSimdLevel::SSE2:
+        updateStatesSSE2(state.get(), count, andMask, orMask);
+        break;
+#endif
+    default:
+        updateStatesScalar(state.get(), count, andMask, orMask);
+        break;
+    }
+}
+
+void GridSoA::pack(size_t first, size_t count, GridInstance* out) const {
+    if (first > cellCount || count > cellCount - first) {
+        VG_LOG_ERROR("Pack range [", first, ", ", first + count, ") is outside the grid of ", cellCount, " cells");
+        throw std::runtime_error("Pack range is outside the grid!");
+    }
+    const float* x = posX.get() + first;
+    const float* y = posY.get() + first;
+    const uint32_t* colors = color.get() + first;
+    const uint32_t* states = state.get() + first;
+    switch (simdLevel) {
+#if VG_GRID_SIMD
+    case GridSimdLevel::AVX2:
+        packAVX2(x, y, colors, states, count, out);
+        break;
+    case GridSimdLevel::SSE2:
+        packSSE2(x, y, colors, states, count, out);
+        break;
+#endif
+    default:
+        packScalar(x, y, colors, states, count, out);
+        break;
+    }
+}
+
+void GridSoA::packInto(GridDataStore& store) const {
+    if (store.getWidth() != width || store.getHeight() != height) {
+        VG_LOG_ERROR("Cannot pack a ", width, "x", height, " grid into a ", store.getWidth(), "x", store.getHeight(), " store");
+        throw std::runtime_error("Grid store dimensions do not match!");
+    }
+    // Each tile row is a contiguous run on both sides; padding cells are left alone.
+    uint32_t tileSize = store.getTileSize();
+    for (uint32_t tileY = 0; tileY < store.getTilesY(); tileY++) {
+        for (uint32_t tileX = 0; tileX < store.getTilesX(); tileX++) {
+            GridInstance* tile = store.editTile(tileX, tileY);
+            uint32_t x = tileX * tileSize;
+            uint32_t columns = std::min(tileSize, width - x);
+            uint32_t rows = std::min(tileSize, height - tileY * tileSize);
+            for (uint32_t row = 0; row < rows; row++) {
+                pack(cellIndex(x, tileY * tileSize + row), columns, tile + row * tileSize);
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "GridTypes.h"
+
+class GridDataStore;
+
+// Instruction set used by GridSoA kernels; see detectGridSimdLevel().
+enum class GridSimdLevel : uint32_t {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+const char* gridSimdLevelName(GridSimdLevel level);
+// Best level this CPU supports, detected once.
+GridSimdLevel detectGridSimdLevel();
+
+/**
+ * @brief Structure-of-arrays cell storage for CPU-side simulation.
+ *
+ * Each attribute lives in its own 64-byte aligned array, indexed row-major
+ * (y * width + x), so bulk updates stream through exactly the bytes they
+ * touch and vectorise cleanly. The kernels pick AVX2, SSE2 or scalar code at
+ * runtime; all levels produce identical results. pack() interleaves a range
+ * into GridInstance, the layout the GPU reads.
+ */
+class GridSoA {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    GridSoA(uint32_t width, uint32_t height);
+
+    GridSoA(const GridSoA&) = delete;
+    GridSoA& operator=(const GridSoA&) = delete;
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    size_t getCellCount() const { return cellCount; }
+    size_t cellIndex(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * width + x; }
+
+    float* positionsX() { return posX.get(); }
+    float* positionsY() { return posY.get(); }
+    uint32_t* colors() { return color.get(); }
+    uint32_t* states() { return state.get(); }
+    const float* positionsX() const { return posX.get(); }
+    const float* positionsY() const { return posY.get(); }
+    const uint32_t* colors() const { return color.get(); }
+    const uint32_t* states() const { return state.get(); }
+
+    // Capped at what the CPU supports; defaults to detectGridSimdLevel().
+    void setSimdLevel(GridSimdLevel level);
+    GridSimdLevel getSimdLevel() const { return simdLevel; }
+
+    // Bulk kernels over every cell.
+    void translate(float dx, float dy);
+    // Scales each RGBA channel by factor / 256 (0 to 256).
+    void fadeColors(uint32_t factor);
+    void fillColor(uint32_t value);
+    // state = (state & andMask) | orMask
+    void updateStates(uint32_t andMask, uint32_t orMask);
+
+    // Interleaves cells [first, first + count) into out.
+    void pack(size_t first, size_t count, GridInstance* out) const;
+    // Packs every cell into its tile of store (same dimensions) and marks all tiles dirty.
+    void packInto(GridDataStore& store) const;
+
+private:
+    struct AlignedDelete {
+        void operator()(void* pointer) const;
+    };
+    template <typename T>
+    using AlignedArray = std::unique_ptr<T[], AlignedDelete>;
+
+    template <typename T>
+    static AlignedArray<T> allocate(size_t count);
+
+    uint32_t width;
+    uint32_t height;
+    size_t cellCount;
+    GridSimdLevel simdLevel;
+
+    AlignedArray<float> posX;
+    AlignedArray<float> posY;
+    AlignedArray<uint32_t> color;
+    AlignedArray<uint32_t> state;
+};
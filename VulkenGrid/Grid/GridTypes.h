@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+// One grid cell as the GPU sees it (std430, 16 bytes). Must match grid.vert.
+struct GridInstance {
+    float x, y;      // World position of the cell's lower-left corner
+    uint32_t color;  // RGBA8, red in the low byte (unpackUnorm4x8)
+    uint32_t state;  // kGridCellAppStateMask application-defined; see kGridCellLevelMask and kGridCellHidden
+};
+static_assert(sizeof(GridInstance) == 16, "GridInstance must match the std430 layout in grid.vert");
+
+// State bits 0-23 belong to the application; 28-30 are reserved.
+constexpr uint32_t kGridCellAppStateMask = 0x00FFFFFFu;
+// State bit of cells that are neither drawn nor kept by culling (e.g. tile padding).
+constexpr uint32_t kGridCellHidden = 0x80000000u;
+// State bits holding a cell's LOD level: it is drawn 2^level times the cell size.
+constexpr uint32_t kGridCellLevelShift = 24;
+constexpr uint32_t kGridCellLevelMask = 0x0F000000u;
+
+// Part of the world shown by the grid renderer.
+struct GridView {
+    float centerX = 0.0f;
+    float centerY = 0.0f;
+    float viewHeight = 1.0f; // World units visible from bottom to top; width follows the aspect ratio
+};
+
+// Push constants of the grid shaders: world -> clip is position * scale + offset.
+struct GridPushConstants {
+    float scale[2];
+    float offset[2];
+    float cellSize;
+};
+static_assert(sizeof(GridPushConstants) == 20, "GridPushConstants must match grid.vert");
+
+// Push constants of grid_cull.comp: cells overlapping [viewMin, viewMax] in world space are kept.
+struct GridCullPushConstants {
+    float viewMin[2];
+    float viewMax[2];
+    float cellSize;
+    uint32_t count;
+};
+static_assert(sizeof(GridCullPushConstants) == 24, "GridCullPushConstants must match grid_cull.comp");
+
+inline uint32_t packGridColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return static_cast<uint32_t>(r) | static_cast<uint32_t>(g) << 8 | static_cast<uint32_t>(b) << 16 | static_cast<uint32_t>(a) << 24;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Size of one preformatted record slot, including the length header. Longer
+// records are cut short and end in kLogTruncationMarker.
+constexpr size_t kLogRecordSize = 512;
+constexpr char kLogTruncationMarker[] = " [truncated]";
+
+struct LogRecord {
+    uint32_t length = 0;
+    char text[kLogRecordSize - sizeof(uint32_t)];
+};
+
+/**
+ * @brief Single-producer/single-consumer ring of preformatted log records.
+ *
+ * Each logging thread owns one ring and is its only producer; the logger's
+ * background writer is the only consumer. Neither side takes a lock: the
+ * producer publishes slots by advancing `head`, the consumer retires them by
+ * advancing `tail`.
+ */
+class LogRingBuffer {
+public:
+    explicit LogRingBuffer(size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1), records(new LogRecord[mask + 1]) {}
+
+    // Producer side: returns the next free slot, or nullptr if the ring is full.
+    LogRecord* tryAcquire() {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead - cachedTail > mask) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (currentHead - cachedTail > mask) {
+                return nullptr;
+            }
+        }
+        return &records[currentHead & mask];
+    }
+
+    // Producer side: publishes the slot handed out by the last tryAcquire().
+    void commit() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer side: number of published records not yet released.
+    size_t readable() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Consumer side: the index-th unreleased record, counted from the oldest.
+    const LogRecord& peek(size_t index) const {
+        return records[(tail.load(std::memory_order_relaxed) + index) & mask];
+    }
+
+    // Consumer side: hands the oldest count records back to the producer.
+    void release(size_t count) {
+        tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer side: called once the owning thread will never produce again.
+    void retire() { retired.store(true, std::memory_order_release); }
+    // Consumer side: true once retired; every record committed before retire() is then readable.
+    bool isRetired() const { return retired.load(std::memory_order_acquire); }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mask;
+    std::unique_ptr<LogRecord[]> records;
+
+    alignas(64) std::atomic<size_t> head{ 0 };
+    size_t cachedTail = 0; // Producer-local snapshot of tail
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    std::atomic<bool> retired{ false };
+};
@@ -1,21 +1,143 @@
 #include "Logger.h"
 #include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <climits>
+#endif
+
+namespace {
+    // Records per thread ring in asynchronous mode.
+    constexpr size_t kThreadBufferCapacity = 1024;
+
+    // Upper bound on iovecs handed to a single writev() call.
+#if !defined(_WIN32) && defined(IOV_MAX)
+    constexpr size_t kMaxBatchRecords = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+    constexpr size_t kMaxBatchRecords = 1024;
+#endif
+
+    // How long the writer sleeps between drains when nobody wakes it.
+    constexpr auto kWriterInterval = std::chrono::milliseconds(5);
+
+    // Owns the calling thread's ring and retires it when the thread exits, so
+    // the writer can free it once the last records are out.
+    struct ThreadBufferHandle {
+        std::shared_ptr<LogRingBuffer> buffer;
+        ~ThreadBufferHandle() {
+            if (buffer) {
+                buffer->retire();
+                buffer.reset();
+            }
+        }
+    };
+    thread_local ThreadBufferHandle threadBuffer;
+
+    // localtime() is both slow and not thread safe, so each thread caches the
+    // formatted timestamp and only rebuilds it when the second changes.
+    struct TimestampCache {
+        std::time_t second = -1;
+        char text[32] = {};
+        size_t length = 0;
+    };
+    thread_local TimestampCache timestampCache;
+
+    const char* levelName(LogLevel level) {
+        switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info:  return "INFO";
+        case LogLevel::Warn:  return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default:              return "OFF";
+        }
+    }
+
+    bool parseLevel(std::string_view text, LogLevel& level) {
+        struct Entry { const char* name; LogLevel level; };
+        static const Entry entries[] = {
+            { "trace", LogLevel::Trace }, { "debug", LogLevel::Debug }, { "info", LogLevel::Info },
+            { "warn", LogLevel::Warn }, { "error", LogLevel::Error }, { "off", LogLevel::Off }
+        };
+        for (const auto& entry : entries) {
+            if (text == entry.name) {
+                level = entry.level;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const TimestampCache& currentTimestamp() {
+        std::time_t now = std::time(nullptr);
+        if (now != timestampCache.second) {
+            std::tm localTime{};
+#ifdef _WIN32
+            localtime_s(&localTime, &now);
+#else
+            localtime_r(&now, &localTime);
+#endif
+            int written = std::snprintf(timestampCache.text, sizeof(timestampCache.text), "%d-%d-%d_%d-%d-%d",
+                                        localTime.tm_year + 1900, localTime.tm_mon + 1, localTime.tm_mday,
+                                        localTime.tm_hour, localTime.tm_min, localTime.tm_sec);
+            timestampCache.length = written > 0 ? std::min(static_cast<size_t>(written), sizeof(timestampCache.text) - 1) : 0;
+            timestampCache.second = now;
+        }
+        return timestampCache;
+    }
+}
 
 Logger::Logger() {
     std::filesystem::create_directory("logs");
     std::string filename = "logs/VulkanGrid_" + getTimestamp() + ".log";
+#ifdef _WIN32
     logFile.open(filename, std::ios::out | std::ios::app);
     if (!logFile.is_open()) {
         throw std::runtime_error("Failed to open log file.");
     }
+#else
+    logFd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd < 0) {
+        throw std::runtime_error("Failed to open log file.");
+    }
+#endif
     log("Logger initialized.");
+
+    if (const char* requested = std::getenv("VULKANGRID_LOG_LEVEL")) {
+        LogLevel level;
+        if (parseLevel(requested, level)) {
+            level = std::max(level, kCompiledLogLevel);
+            log(std::string("Runtime log level set to ") + levelName(level) + ".");
+            setLevel(level);
+        } else {
+            logError(std::string("Unknown VULKANGRID_LOG_LEVEL value: ") + requested);
+        }
+    }
 }
 
 Logger::~Logger() {
     log("Logger shutting down.");
+    stopWriter();
+    drainBuffers();
+#ifdef _WIN32
     if (logFile.is_open()) {
         logFile.close();
     }
+#else
+    if (logFd >= 0) {
+        ::close(logFd);
+        logFd = -1;
+    }
+#endif
 }
 
 Logger& Logger::getInstance() {
@@ -24,11 +146,46 @@ Logger& Logger::getInstance() {
 }
 
 void Logger::log(const std::string& message) {
-    writeLog("INFO", message);
+    if (isEnabled(LogLevel::Info)) {
+        writeLog(LogLevel::Info, message);
+    }
 }
 
 void Logger::logError(const std::string& message) {
-    writeLog("ERROR", message);
+    if (isEnabled(LogLevel::Error)) {
+        writeLog(LogLevel::Error, message);
+    }
+}
+
+LogMessageBuilder& threadLogMessageBuilder() {
+    thread_local LogMessageBuilder builder;
+    return builder;
+}
+
+void Logger::setMode(LogMode newMode, LogOverflowPolicy policy) {
+    overflowPolicy.store(policy, std::memory_order_relaxed);
+    if (newMode == mode.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    if (newMode == LogMode::Asynchronous) {
+        startWriter();
+        mode.store(LogMode::Asynchronous, std::memory_order_release);
+        log("Logger switched to asynchronous mode.");
+    } else {
+        mode.store(LogMode::Synchronous, std::memory_order_release);
+        stopWriter();
+        drainBuffers();
+        log("Logger switched to synchronous mode.");
+    }
+}
+
+void Logger::flush() {
+    drainBuffers();
+#ifdef _WIN32
+    std::lock_guard<std::mutex> guard(logMutex);
+    logFile.flush();
+#endif
 }
 
 std::string Logger::getTimestamp() {
@@ -44,7 +201,216 @@ std::string Logger::getTimestamp() {
     return ss.str();
 }
 
-void Logger::writeLog(const std::string& level, const std::string& message) {
+size_t Logger::formatRecord(char* out, size_t capacity, const char* level, std::string_view message) {
+    // Layout: "[timestamp] [LEVEL] message\n", truncated to fit capacity.
+    const TimestampCache& timestamp = currentTimestamp();
+    size_t levelLength = std::strlen(level);
+    size_t prefixLength = timestamp.length + levelLength + 5;
+    if (capacity < prefixLength + 1) {
+        return 0;
+    }
+
+    char* cursor = out;
+    *cursor++ = '[';
+    std::memcpy(cursor, timestamp.text, timestamp.length);
+    cursor += timestamp.length;
+    *cursor++ = ']';
+    *cursor++ = ' ';
+    *cursor++ = '[';
+    std::memcpy(cursor, level, levelLength);
+    cursor += levelLength;
+    *cursor++ = ']';
+    *cursor++ = ' ';
+
+    size_t room = capacity - prefixLength - 1;
+    if (message.size() <= room) {
+        std::memcpy(cursor, message.data(), message.size());
+        cursor += message.size();
+    } else {
+        // Mark the cut so a shortened record is never mistaken for the whole message.
+        size_t markerLength = std::min(sizeof(kLogTruncationMarker) - 1, room);
+        size_t messageLength = room - markerLength;
+        std::memcpy(cursor, message.data(), messageLength);
+        cursor += messageLength;
+        std::memcpy(cursor, kLogTruncationMarker, markerLength);
+        cursor += markerLength;
+    }
+    *cursor++ = '\n';
+    return static_cast<size_t>(cursor - out);
+}
+
+void Logger::writeLog(LogLevel severity, std::string_view message) {
+    const char* level = levelName(severity);
+    if (mode.load(std::memory_order_acquire) == LogMode::Asynchronous) {
+        LogRingBuffer& buffer = getThreadBuffer();
+        LogRecord* record = buffer.tryAcquire();
+        while (record == nullptr) {
+            if (overflowPolicy.load(std::memory_order_relaxed) == LogOverflowPolicy::Drop) {
+                droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (writerRunning.load(std::memory_order_acquire)) {
+                writerWake.notify_one();
+                std::this_thread::yield();
+            } else {
+                // Nobody else will free a slot (the writer is stopping or gone), so drain here.
+                drainBuffers();
+            }
+            record = buffer.tryAcquire();
+        }
+        record->length = static_cast<uint32_t>(formatRecord(record->text, sizeof(record->text), level, message));
+        buffer.commit();
+        return;
+    }
+
+    // Synchronous path: format on the stack unless the message is too long for it.
+    char stackRecord[kLogRecordSize];
+    size_t length = formatRecord(stackRecord, sizeof(stackRecord), level, message);
+    if (length > 0 && message.size() + 64 < sizeof(stackRecord)) {
+        std::lock_guard<std::mutex> guard(logMutex);
+        writeRaw(stackRecord, length);
+        return;
+    }
+
+    std::string line = "[" + getTimestamp() + "] [" + level + "] " + std::string(message) + "\n";
     std::lock_guard<std::mutex> guard(logMutex);
-    logFile << "[" << getTimestamp() << "] [" << level << "] " << message << std::endl;
+    writeRaw(line.data(), line.size());
+}
+
+LogRingBuffer& Logger::getThreadBuffer() {
+    if (!threadBuffer.buffer) {
+        // First asynchronous record from this thread: register its ring once.
+        auto buffer = std::make_shared<LogRingBuffer>(kThreadBufferCapacity);
+        std::lock_guard<std::mutex> guard(buffersMutex);
+        threadBuffers.push_back(buffer);
+        threadBuffer.buffer = std::move(buffer);
+    }
+    return *threadBuffer.buffer;
+}
+
+void Logger::startWriter() {
+    std::lock_guard<std::mutex> guard(writerMutex);
+    if (writerThread.joinable()) {
+        return;
+    }
+    writerStopping = false;
+    writerRunning.store(true, std::memory_order_release);
+    writerThread = std::thread(&Logger::writerLoop, this);
+}
+
+void Logger::stopWriter() {
+    {
+        std::lock_guard<std::mutex> guard(writerMutex);
+        if (!writerThread.joinable()) {
+            return;
+        }
+        writerStopping = true;
+        writerRunning.store(false, std::memory_order_release);
+    }
+    writerWake.notify_one();
+    writerThread.join();
+}
+
+void Logger::writerLoop() {
+    std::unique_lock<std::mutex> lock(writerMutex);
+    while (!writerStopping) {
+        writerWake.wait_for(lock, kWriterInterval);
+        lock.unlock();
+        drainBuffers();
+        lock.lock();
+    }
+}
+
+void Logger::drainBuffers() {
+    // Held for the whole drain: only one consumer may touch the rings, and
+    // producers only take it when a new thread registers.
+    std::lock_guard<std::mutex> buffersGuard(buffersMutex);
+
+    uint64_t dropped = droppedRecords.load(std::memory_order_relaxed);
+    if (dropped != reportedDroppedRecords) {
+        char notice[kLogRecordSize];
+        std::string message = std::to_string(dropped - reportedDroppedRecords) + " log records dropped (ring buffer full).";
+        size_t length = formatRecord(notice, sizeof(notice), "WARN", message);
+        std::lock_guard<std::mutex> guard(logMutex);
+        writeRaw(notice, length);
+        reportedDroppedRecords = dropped;
+    }
+
+    for (auto it = threadBuffers.begin(); it != threadBuffers.end();) {
+        const std::shared_ptr<LogRingBuffer>& buffer = *it;
+        // Checked before draining: once retired, nothing more can be committed.
+        bool retired = buffer->isRetired();
+        size_t pending = buffer->readable();
+        while (pending > 0) {
+            size_t batch = std::min(pending, kMaxBatchRecords);
+            std::lock_guard<std::mutex> guard(logMutex);
+#ifdef _WIN32
+            for (size_t i = 0; i < batch; i++) {
+                const LogRecord& record = buffer->peek(i);
+                logFile.write(record.text, record.length);
+            }
+            logFile.flush();
+#else
+            iovec vectors[kMaxBatchRecords];
+            size_t remaining = 0;
+            for (size_t i = 0; i < batch; i++) {
+                const LogRecord& record = buffer->peek(i);
+                vectors[i].iov_base = const_cast<char*>(record.text);
+                vectors[i].iov_len = record.length;
+                remaining += record.length;
+            }
+
+            // writev() may stop short; skip over whatever it did write and retry.
+            iovec* next = vectors;
+            int count = static_cast<int>(batch);
+            while (remaining > 0) {
+                ssize_t written = ::writev(logFd, next, count);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                remaining -= static_cast<size_t>(written);
+                size_t consumed = static_cast<size_t>(written);
+                while (count > 0 && consumed >= next->iov_len) {
+                    consumed -= next->iov_len;
+                    next++;
+                    count--;
+                }
+                if (count > 0) {
+                    next->iov_base = static_cast<char*>(next->iov_base) + consumed;
+                    next->iov_len -= consumed;
+                }
+            }
+#endif
+            buffer->release(batch);
+            pending -= batch;
+        }
+
+        if (retired) {
+            it = threadBuffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Logger::writeRaw(const char* data, size_t size) {
+#ifdef _WIN32
+    logFile.write(data, size);
+    logFile.flush();
+#else
+    while (size > 0) {
+        ssize_t written = ::write(logFd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+#endif
 }
@@ -5,21 +5,193 @@
 #include <sstream>
 #include <ctime>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <charconv>
+#include <cstdio>
+
+#include "LogRingBuffer.h"
+
+enum class LogLevel : int {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Off = 5
+};
+
+// Lowest level compiled into the binary; set from CMake (VULKANGRID_LOG_LEVEL).
+// Call sites below it are discarded by the VG_LOG_* macros at compile time.
+#ifndef VULKANGRID_LOG_LEVEL
+#define VULKANGRID_LOG_LEVEL 2
+#endif
+constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>(VULKANGRID_LOG_LEVEL);
+
+// Synchronous writes every record on the calling thread; Asynchronous hands
+// preformatted records to a background writer through per-thread rings.
+enum class LogMode {
+    Synchronous,
+    Asynchronous
+};
+
+// What a producer does when its ring is full in asynchronous mode.
+enum class LogOverflowPolicy {
+    Drop,   // Discard the record and count it
+    Block   // Wait for the writer to free a slot, or drain the rings itself when no writer runs
+};
 
 class Logger {
 public:
     static Logger& getInstance();
-    
+
     void log(const std::string& message);
     void logError(const std::string& message);
 
+    // Runtime threshold; defaults to the compiled level and can be raised with
+    // the VULKANGRID_LOG_LEVEL environment variable (trace/debug/info/warn/error/off).
+    void setLevel(LogLevel level) { runtimeLevel.store(level, std::memory_order_relaxed); }
+    LogLevel getLevel() const { return runtimeLevel.load(std::memory_order_relaxed); }
+    bool isEnabled(LogLevel level) const {
+        return level >= kCompiledLogLevel && level >= runtimeLevel.load(std::memory_order_relaxed);
+    }
+
+    // Formats args into a per-thread scratch buffer (no heap allocation for
+    // numbers and string literals) and writes the result. Use the VG_LOG_*
+    // macros so disabled levels never evaluate their arguments.
+    template <typename... Args>
+    void logFormat(LogLevel level, const Args&... args);
+
+    void setMode(LogMode mode, LogOverflowPolicy policy = LogOverflowPolicy::Drop);
+    LogMode getMode() const { return mode.load(std::memory_order_relaxed); }
+
+    // Writes out everything queued so far, regardless of mode.
+    void flush();
+
+    uint64_t getDroppedRecordCount() const { return droppedRecords.load(std::memory_order_relaxed); }
+
 private:
     Logger();
     ~Logger();
 
+#ifdef _WIN32
     std::ofstream logFile;
+#else
+    int logFd = -1;
+#endif
     std::mutex logMutex;
 
+    std::atomic<LogLevel> runtimeLevel{ kCompiledLogLevel };
+    std::atomic<LogMode> mode{ LogMode::Synchronous };
+    std::atomic<LogOverflowPolicy> overflowPolicy{ LogOverflowPolicy::Drop };
+    std::atomic<uint64_t> droppedRecords{ 0 };
+    uint64_t reportedDroppedRecords = 0;
+
+    // Rings of threads that have logged asynchronously; guarded by buffersMutex.
+    // A thread's ring is retired when it exits and freed once drained.
+    std::vector<std::shared_ptr<LogRingBuffer>> threadBuffers;
+    std::mutex buffersMutex;
+
+    std::thread writerThread;
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    bool writerStopping = false;
+    std::atomic<bool> writerRunning{ false };
+
     std::string getTimestamp();
-    void writeLog(const std::string& level, const std::string& message);
+    void writeLog(LogLevel level, std::string_view message);
+    size_t formatRecord(char* out, size_t capacity, const char* level, std::string_view message);
+
+    LogRingBuffer& getThreadBuffer();
+    void startWriter();
+    void stopWriter();
+    void writerLoop();
+    void drainBuffers();
+    void writeRaw(const char* data, size_t size);
 };
+
+// Fixed-capacity scratch buffer used by Logger::logFormat; overlong messages are truncated.
+class LogMessageBuilder {
+public:
+    void clear() { length = 0; }
+    std::string_view view() const { return std::string_view(data, length); }
+
+    void append(std::string_view text) {
+        size_t count = text.size() < sizeof(data) - length ? text.size() : sizeof(data) - length;
+        text.copy(data + length, count);
+        length += count;
+    }
+    void append(const char* text) { append(std::string_view(text ? text : "(null)")); }
+    void append(const std::string& text) { append(std::string_view(text)); }
+    void append(char value) { append(std::string_view(&value, 1)); }
+    void append(bool value) { append(value ? std::string_view("true") : std::string_view("false")); }
+    void append(const void* pointer) { appendFormatted("%p", pointer); }
+
+    template <typename T>
+    void append(const T& value) {
+        if constexpr (std::is_enum_v<T>) {
+            append(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            auto result = std::to_chars(data + length, data + sizeof(data), value);
+            if (result.ec == std::errc()) {
+                length = static_cast<size_t>(result.ptr - data);
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            appendFormatted("%g", static_cast<double>(value));
+        } else if constexpr (std::is_pointer_v<T>) {
+            append(static_cast<const void*>(value));
+        } else {
+            static_assert(std::is_convertible_v<const T&, std::string_view>, "Unsupported log argument type");
+            append(std::string_view(value));
+        }
+    }
+
+private:
+    template <typename... Values>
+    void appendFormatted(const char* format, Values... values) {
+        // snprintf needs room for its terminator; a full buffer (e.g. from to_chars) takes nothing more.
+        if (length >= sizeof(data) - 1) {
+            return;
+        }
+        int written = std::snprintf(data + length, sizeof(data) - length, format, values...);
+        if (written > 0) {
+            length += static_cast<size_t>(written) < sizeof(data) - length ? static_cast<size_t>(written) : sizeof(data) - length - 1;
+        }
+    }
+
+    char data[kLogRecordSize];
+    size_t length = 0;
+};
+
+LogMessageBuilder& threadLogMessageBuilder();
+
+template <typename... Args>
+void Logger::logFormat(LogLevel level, const Args&... args) {
+    LogMessageBuilder& builder = threadLogMessageBuilder();
+    builder.clear();
+    (builder.append(args), ...);
+    writeLog(level, builder.view());
+}
+
+// Level-filtered logging. Levels below kCompiledLogLevel compile to nothing;
+// levels disabled at runtime skip argument evaluation entirely.
+#define VG_LOG(level, ...)                                              \
+    do {                                                                \
+        if constexpr ((level) >= kCompiledLogLevel) {                   \
+            if (Logger::getInstance().isEnabled(level)) {               \
+                Logger::getInstance().logFormat((level), __VA_ARGS__);  \
+            }                                                           \
+        }                                                               \
+    } while (0)
+
+#define VG_LOG_TRACE(...) VG_LOG(LogLevel::Trace, __VA_ARGS__)
+#define VG_LOG_DEBUG(...) VG_LOG(LogLevel::Debug, __VA_ARGS__)
+#define VG_LOG_INFO(...)  VG_LOG(LogLevel::Info, __VA_ARGS__)
+#define VG_LOG_WARN(...)  VG_LOG(LogLevel::Warn, __VA_ARGS__)
+#define VG_LOG_ERROR(...) VG_LOG(LogLevel::Error, __VA_ARGS__)
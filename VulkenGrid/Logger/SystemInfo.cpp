@@ -1,11 +1,11 @@
 #include "SystemInfo.h"
+#include "Logger.h"
 #include <iostream>
 #include <sstream>
 #include <vector>
 #ifdef _WIN32
 #include <Windows.h>
 #include <intrin.h>
-#include "Logger.h"
 #include <VersionHelpers.h>
 #include <dxgi1_6.h>
 #include <atlbase.h>
@@ -0,0 +1,144 @@
+#include "TraceRecorder.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    void writeJsonString(std::ofstream& out, const char* text) {
+        out << '"';
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\' << *c;
+            } else if (static_cast<unsigned char>(*c) < 0x20) {
+                out << ' ';
+            } else {
+                out << *c;
+            }
+        }
+        out << '"';
+    }
+}
+
+TraceRecorder::TraceRecorder() : epoch(Clock::now()) {
+    if (const char* requested = std::getenv("VULKANGRID_TRACE")) {
+        if (std::strcmp(requested, "0") == 0 || std::strcmp(requested, "off") == 0) {
+            return;
+        }
+        if (std::strcmp(requested, "1") != 0 && std::strcmp(requested, "on") != 0) {
+            outputPath = requested;
+        }
+        setEnabled(true);
+    }
+}
+
+TraceRecorder& TraceRecorder::getInstance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::getThreadBuffer() {
+    // Shared with the registry so the buffer survives its thread until exported.
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer->threadId = static_cast<uint32_t>(threadBuffers.size()) + 1;
+        threadBuffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void TraceRecorder::setThreadName(const char* name) {
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+void TraceRecorder::record(const char* name, Clock::time_point start, Clock::time_point end) {
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.capacity() == 0) {
+        // Allocated on first use so threads that never record stay cheap.
+        buffer.events.reserve(kEventsPerThread);
+    }
+    if (buffer.events.size() >= kEventsPerThread) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint64_t startNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count());
+    uint64_t durationNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    buffer.events.push_back({ name, startNs, durationNs });
+}
+
+bool TraceRecorder::writeChromeTrace(const std::string& path) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(parent, error);
+    }
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        VG_LOG_ERROR("Failed to open trace file ", path);
+        return false;
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers = threadBuffers;
+    }
+
+    // Complete ("X") events in microseconds, plus one thread-name metadata event per named thread.
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    uint64_t written = 0;
+    char number[64];
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (!buffer->threadName.empty()) {
+            out << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"args\":{\"name\":";
+            writeJsonString(out, buffer->threadName.c_str());
+            out << "}}";
+            first = false;
+        }
+        for (const auto& event : buffer->events) {
+            out << (first ? "" : ",") << "\n{\"ph\":\"X\",\"cat\":\"cpu\",\"name\":";
+            writeJsonString(out, event.name);
+            std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f", event.startNs / 1000.0, event.durationNs / 1000.0);
+            out << number << ",\"pid\":1,\"tid\":" << buffer->threadId << '}';
+            first = false;
+            written++;
+        }
+    }
+    out << "\n]}\n";
+    out.close();
+    if (!out) {
+        VG_LOG_ERROR("Failed to write trace file ", path);
+        return false;
+    }
+    VG_LOG_INFO("Wrote ", written, " trace events to ", path, " (", getDroppedEventCount(), " dropped).");
+    return true;
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (const auto& buffer : threadBuffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+    droppedEvents.store(0, std::memory_order_relaxed);
+}
+
+uint64_t TraceRecorder::getEventCount() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t count = 0;
+    for (const auto& buffer : threadBuffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += buffer->events.size();
+    }
+    return count;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set to 0 (CMake option VULKANGRID_ENABLE_TRACING) to compile every
+// VG_TRACE_SCOPE out; otherwise a disabled scope costs one relaxed load.
+#ifndef VULKANGRID_ENABLE_TRACING
+#define VULKANGRID_ENABLE_TRACING 1
+#endif
+
+// A completed scope. name must outlive the recorder (string literals).
+struct TraceEvent {
+    const char* name;
+    uint64_t startNs;    // Since the recorder was created
+    uint64_t durationNs;
+};
+
+/**
+ * @brief Collects timed CPU scopes and exports them as Chrome trace events.
+ *
+ * Each thread appends to its own fixed-capacity buffer, so recording threads
+ * never contend with each other; events beyond the capacity are dropped and
+ * counted. The file written by writeChromeTrace() opens in chrome://tracing
+ * or Perfetto.
+ *
+ * Recording is off by default. The VULKANGRID_TRACE environment variable
+ * enables it at startup: "1"/"on" writes to logs/trace.json, any other value
+ * is used as the output path.
+ */
+class TraceRecorder {
+public:
+    static constexpr size_t kEventsPerThread = 1 << 16;
+
+    using Clock = std::chrono::steady_clock;
+
+    static TraceRecorder& getInstance();
+
+    void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    const std::string& getOutputPath() const { return outputPath; }
+    void setOutputPath(const std::string& path) { outputPath = path; }
+
+    // Name shown for the calling thread's track.
+    void setThreadName(const char* name);
+
+    void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+    // Writes every event recorded so far; returns false if the file cannot be written.
+    bool writeChromeTrace(const std::string& path);
+    void clear();
+
+    uint64_t getEventCount();
+    uint64_t getDroppedEventCount() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+    struct ThreadBuffer {
+        std::mutex mutex; // Only contended while exporting
+        std::vector<TraceEvent> events;
+        std::string threadName;
+        uint32_t threadId = 0;
+    };
+
+    TraceRecorder();
+
+    ThreadBuffer& getThreadBuffer();
+
+    std::atomic<bool> enabled{ false };
+    std::atomic<uint64_t> droppedEvents{ 0 };
+    Clock::time_point epoch;
+    std::string outputPath = "logs/trace.json";
+
+    // Buffers of every thread that has recorded; guarded by buffersMutex.
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+    std::mutex buffersMutex;
+};
+
+// Records the enclosing block when tracing was enabled at its start.
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) {
+        if (TraceRecorder::getInstance().isEnabled()) {
+            scopeName = name;
+            start = TraceRecorder::Clock::now();
+        }
+    }
+    ~TraceScope() {
+        if (scopeName) {
+            TraceRecorder::getInstance().record(scopeName, start, TraceRecorder::Clock::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* scopeName = nullptr;
+    TraceRecorder::Clock::time_point start;
+};
+
+#define VG_TRACE_CONCAT_INNER(a, b) a##b
+#define VG_TRACE_CONCAT(a, b) VG_TRACE_CONCAT_INNER(a, b)
+
+#if VULKANGRID_ENABLE_TRACING
+#define VG_TRACE_SCOPE(name) TraceScope VG_TRACE_CONCAT(vgTraceScope, __LINE__)(name)
+#else
+#define VG_TRACE_SCOPE(name) do {} while (0)
+#endif
@@ -0,0 +1,75 @@
+#include "ComputePipeline.h"
+#include "VulkanDevice.h"
+#include "PipelineCache.h"
+#include "ShaderModule.h"
+#include <stdexcept>
+
+ComputePipeline::ComputePipeline(VulkanDevice& device, PipelineCache* pipelineCache)
+    : device(device), pipelineCache(pipelineCache) {}
+
+ComputePipeline::~ComputePipeline() {
+    cleanup();
+}
+
+void ComputePipeline::create(const std::string& shaderPath, const std::vector<VkDescriptorSetLayout>& setLayouts, uint32_t pushConstantSize) {
+    VG_LOG_DEBUG("Creating compute pipeline for ", shaderPath, "...");
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = pushConstantSize;
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    layoutInfo.pSetLayouts = setLayouts.data();
+    layoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+    layoutInfo.pPushConstantRanges = pushConstantSize > 0 ? &pushConstantRange : nullptr;
+
+    VkResult result = vkCreatePipelineLayout(device.getDevice(), &layoutInfo, nullptr, &pipelineLayout);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create compute pipeline layout. VkResult: ", result);
+        throw std::runtime_error("Failed to create compute pipeline layout!");
+    }
+
+    // The module only needs to live until the pipeline is created
+    ShaderModule shader(device.getDevice(), shaderPath, VK_SHADER_STAGE_COMPUTE_BIT);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shader.getPipelineShaderStageCreateInfo();
+    pipelineInfo.layout = pipelineLayout;
+
+    VkPipelineCache cache = pipelineCache ? pipelineCache->getCache() : VK_NULL_HANDLE;
+    result = vkCreateComputePipelines(device.getDevice(), cache, 1, &pipelineInfo, nullptr, &pipeline);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create compute pipeline for ", shaderPath, ". VkResult: ", result);
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+    VG_LOG_INFO("Compute pipeline created for ", shaderPath, ".");
+}
+
+void ComputePipeline::cleanup() {
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device.getDevice(), pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device.getDevice(), pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+}
+
+void ComputePipeline::bind(VkCommandBuffer commandBuffer) const {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+}
+
+void ComputePipeline::dispatch(VkCommandBuffer commandBuffer, uint32_t itemCount, uint32_t groupSize) const {
+    uint32_t groups = itemCount / groupSize + (itemCount % groupSize != 0 ? 1 : 0);
+    if (groups == 0) {
+        return;
+    }
+    uint32_t groupsX = groups < kMaxGroupsPerDimension ? groups : kMaxGroupsPerDimension;
+    uint32_t groupsY = (groups + groupsX - 1) / groupsX;
+    vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+}
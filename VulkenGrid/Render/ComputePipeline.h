@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class VulkanDevice;
+class PipelineCache;
+
+/**
+ * @brief A compute shader with its pipeline layout.
+ *
+ * The layout is built from the caller's descriptor set layouts (which the
+ * caller keeps owning) plus one compute-stage push constant range.
+ */
+class ComputePipeline {
+public:
+    // Every implementation supports at least this many workgroups per dimension.
+    static constexpr uint32_t kMaxGroupsPerDimension = 65535;
+
+    ComputePipeline(VulkanDevice& device, PipelineCache* pipelineCache = nullptr);
+    ~ComputePipeline();
+
+    ComputePipeline(const ComputePipeline&) = delete;
+    ComputePipeline& operator=(const ComputePipeline&) = delete;
+
+    void create(const std::string& shaderPath, const std::vector<VkDescriptorSetLayout>& setLayouts, uint32_t pushConstantSize = 0);
+    void cleanup();
+
+    VkPipeline getPipeline() const { return pipeline; }
+    VkPipelineLayout getLayout() const { return pipelineLayout; }
+
+    void bind(VkCommandBuffer commandBuffer) const;
+    // Dispatches enough groups of groupSize invocations for itemCount items. Counts
+    // above kMaxGroupsPerDimension groups spill into y; shaders flatten the group ID.
+    void dispatch(VkCommandBuffer commandBuffer, uint32_t itemCount, uint32_t groupSize) const;
+
+private:
+    VulkanDevice& device;
+    PipelineCache* pipelineCache;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+};
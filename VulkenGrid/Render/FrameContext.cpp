@@ -0,0 +1,141 @@
+#include "FrameContext.h"
+#include "VulkanDevice.h"
+#include "TraceRecorder.h"
+#include <stdexcept>
+#include <algorithm>
+
+FrameContextRing::FrameContextRing(VulkanDevice& device, uint32_t framesInFlight)
+    : device(device), framesInFlight(std::max(framesInFlight, 1u)) {}
+
+FrameContextRing::~FrameContextRing() {
+    cleanup();
+}
+
+void FrameContextRing::init() {
+    VG_LOG_INFO("Creating ", framesInFlight, " frame contexts...");
+    VkDevice logicalDevice = device.getDevice();
+    frames.resize(framesInFlight);
+
+    // Two per slot: the frame's own and the one for its inline uploads.
+    std::vector<VkCommandBuffer> commandBuffers(framesInFlight * 2);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = device.getCommandPool();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = framesInFlight * 2;
+
+    VkResult result = vkAllocateCommandBuffers(logicalDevice, &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate frame command buffers. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate frame command buffers!");
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // Fences start signaled so the first wait on each slot returns immediately.
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        FrameContext& frame = frames[i];
+        frame.index = i;
+        frame.commandBuffer = commandBuffers[i];
+        frame.uploadCommandBuffer = commandBuffers[framesInFlight + i];
+
+        if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS ||
+            vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &frame.renderFinishedSemaphore) != VK_SUCCESS ||
+            vkCreateFence(logicalDevice, &fenceInfo, nullptr, &frame.inFlightFence) != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to create synchronization objects for frame context ", i);
+            throw std::runtime_error("Failed to create frame synchronization objects!");
+        }
+    }
+
+    // Starts at the last frame number so a re-initialised ring keeps counting upwards.
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = frameNumber;
+    semaphoreInfo.pNext = &typeInfo;
+
+    result = vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &timelineSemaphore);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create frame timeline semaphore. VkResult: ", result);
+        throw std::runtime_error("Failed to create frame timeline semaphore!");
+    }
+    VG_LOG_INFO("Frame contexts created successfully.");
+}
+
+void FrameContextRing::cleanup() {
+    if (frames.empty()) {
+        return;
+    }
+
+    VkDevice logicalDevice = device.getDevice();
+    waitIdle();
+    for (auto& frame : frames) {
+        if (frame.inFlightFence != VK_NULL_HANDLE) {
+            vkDestroyFence(logicalDevice, frame.inFlightFence, nullptr);
+        }
+        if (frame.imageAvailableSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(logicalDevice, frame.imageAvailableSemaphore, nullptr);
+        }
+        if (frame.renderFinishedSemaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(logicalDevice, frame.renderFinishedSemaphore, nullptr);
+        }
+        if (frame.commandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(logicalDevice, device.getCommandPool(), 1, &frame.commandBuffer);
+        }
+        if (frame.uploadCommandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(logicalDevice, device.getCommandPool(), 1, &frame.uploadCommandBuffer);
+        }
+    }
+    frames.clear();
+    if (timelineSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(logicalDevice, timelineSemaphore, nullptr);
+        timelineSemaphore = VK_NULL_HANDLE;
+    }
+    VG_LOG_INFO("Frame contexts destroyed.");
+}
+
+FrameContext& FrameContextRing::beginFrame() {
+    VG_TRACE_SCOPE("FrameContextRing::beginFrame");
+    FrameContext& frame = frames[currentIndex];
+    if (frameOpen) {
+        // The previous frame was abandoned before submission (e.g. an out-of-date
+        // swapchain); its slot is still free and keeps the same frame number.
+        return frame;
+    }
+
+    VkResult result = vkWaitForFences(device.getDevice(), 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to wait for frame fence. VkResult: ", result);
+        throw std::runtime_error("Failed to wait for frame fence!");
+    }
+
+    // Frames retire in submission order, so everything up to this slot's last frame is done.
+    completedFrameNumber = std::max(completedFrameNumber, frame.frameNumber);
+    frame.frameNumber = ++frameNumber;
+    frameOpen = true;
+    VG_LOG_TRACE("Begin frame ", frameNumber, " on slot ", currentIndex);
+    return frame;
+}
+
+void FrameContextRing::endFrame() {
+    frameOpen = false;
+    currentIndex = (currentIndex + 1) % framesInFlight;
+}
+
+void FrameContextRing::waitIdle() {
+    std::vector<VkFence> fences;
+    for (const auto& frame : frames) {
+        if (frame.inFlightFence != VK_NULL_HANDLE) {
+            fences.push_back(frame.inFlightFence);
+        }
+    }
+    if (!fences.empty()) {
+        vkWaitForFences(device.getDevice(), static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+    }
+    completedFrameNumber = frameOpen ? frameNumber - 1 : frameNumber;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+
+class VulkanDevice;
+
+// Per-frame resources. Nothing in here may be reused until inFlightFence signals.
+struct FrameContext {
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkCommandBuffer uploadCommandBuffer = VK_NULL_HANDLE;  // Small uploads recorded ahead of the frame
+    VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
+    VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
+    VkFence inFlightFence = VK_NULL_HANDLE;
+    uint32_t index = 0;        // Slot in the ring
+    uint64_t frameNumber = 0;  // Frame this slot is (or was last) used for; 0 = never
+};
+
+/**
+ * @brief Ring of FrameContexts that bounds how far the CPU may run ahead of the GPU.
+ *
+ * With N frames in flight the CPU records frame F while the GPU is still
+ * executing up to N - 1 earlier frames. beginFrame() blocks on the fence of
+ * the slot being reused, which is what keeps the CPU from overwriting
+ * resources the GPU is still reading.
+ *
+ * Each frame's submission also signals its frame number on a timeline
+ * semaphore, so other queues can wait for a frame without a CPU round trip.
+ */
+class FrameContextRing {
+public:
+    static constexpr uint32_t kDefaultFramesInFlight = 2;
+
+    FrameContextRing(VulkanDevice& device, uint32_t framesInFlight = kDefaultFramesInFlight);
+    ~FrameContextRing();
+
+    void init();
+    void cleanup();
+
+    // Waits for the GPU to release the next slot, then hands it out for a new frame.
+    FrameContext& beginFrame();
+    // Advances to the next slot; call once the current frame has been submitted.
+    // A frame that is abandoned before submission is simply begun again.
+    void endFrame();
+
+    // Blocks until every submitted frame has finished on the GPU.
+    void waitIdle();
+
+    FrameContext& current() { return frames[currentIndex]; }
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+    uint32_t getCurrentIndex() const { return currentIndex; }
+    // Number of the frame being built (starts at 1).
+    uint64_t getFrameNumber() const { return frameNumber; }
+    // Every frame with a number <= this value has finished on the GPU.
+    uint64_t getCompletedFrameNumber() const { return completedFrameNumber; }
+    // Reaches a frame's number once that frame's submission has finished.
+    VkSemaphore getTimelineSemaphore() const { return timelineSemaphore; }
+
+private:
+    VulkanDevice& device;
+    uint32_t framesInFlight;
+    uint32_t currentIndex = 0;
+    uint64_t frameNumber = 0;
+    uint64_t completedFrameNumber = 0;
+    bool frameOpen = false;
+    std::vector<FrameContext> frames;
+    VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+};
@@ -0,0 +1,277 @@
+#include "GpuProfiler.h"
+#include "VulkanDevice.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr const char* kFrameScopeName = "render pass";
+}
+
+GpuProfiler::GpuProfiler(VulkanDevice& device, uint32_t framesInFlight, uint32_t maxScopesPerFrame)
+    : device(device), framesInFlight(std::max(framesInFlight, 1u)), maxQueries(std::max(maxScopesPerFrame, 1u) * 2) {}
+
+GpuProfiler::~GpuProfiler() {
+    cleanup();
+}
+
+void GpuProfiler::init() {
+    VG_LOG_INFO("Initializing GPU profiler...");
+
+    uint32_t graphicsFamily = device.getQueueFamilyIndices().graphicsFamily.value();
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device.getPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device.getPhysicalDevice(), &familyCount, families.data());
+
+    uint32_t validBits = graphicsFamily < familyCount ? families[graphicsFamily].timestampValidBits : 0;
+    float timestampPeriod = device.getProperties().limits.timestampPeriod;
+    if (validBits == 0 || timestampPeriod <= 0.0f) {
+        VG_LOG_WARN("Graphics queue does not support timestamp queries; GPU profiling disabled.");
+        supported = false;
+        return;
+    }
+    // Only the low validBits of a timestamp are meaningful; mask before taking differences.
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    nanosecondsPerTick = timestampPeriod;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = graphicsFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    VkResult result = vkCreateCommandPool(device.getDevice(), &poolInfo, nullptr, &commandPool);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create GPU profiler command pool. VkResult: ", result);
+        throw std::runtime_error("Failed to create GPU profiler command pool!");
+    }
+
+    std::vector<VkCommandBuffer> commandBuffers(framesInFlight * 2);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+    result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to allocate GPU profiler command buffers. VkResult: ", result);
+        throw std::runtime_error("Failed to allocate GPU profiler command buffers!");
+    }
+
+    slots.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        VkQueryPoolCreateInfo queryInfo{};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = maxQueries;
+
+        result = vkCreateQueryPool(device.getDevice(), &queryInfo, nullptr, &slots[i].queryPool);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to create timestamp query pool. VkResult: ", result);
+            throw std::runtime_error("Failed to create timestamp query pool!");
+        }
+        slots[i].beginCommands = commandBuffers[i * 2];
+        slots[i].endCommands = commandBuffers[i * 2 + 1];
+    }
+
+    supported = true;
+    VG_LOG_INFO("GPU profiler initialized (", framesInFlight, " query pools of ", maxQueries, " timestamps, ",
+                nanosecondsPerTick, " ns per tick, ", validBits, " valid bits).");
+}
+
+void GpuProfiler::cleanup() {
+    if (commandPool == VK_NULL_HANDLE) {
+        return;
+    }
+    // Callers have waited for the GPU by now, so no query is still being written.
+    for (auto& slot : slots) {
+        vkDestroyQueryPool(device.getDevice(), slot.queryPool, nullptr);
+    }
+    slots.clear();
+    currentSlot = nullptr;
+    vkDestroyCommandPool(device.getDevice(), commandPool, nullptr);
+    commandPool = VK_NULL_HANDLE;
+    supported = false;
+    VG_LOG_INFO("GPU profiler destroyed.");
+}
+
+VkCommandBuffer GpuProfiler::beginFrame(uint32_t frameSlot, uint64_t frameNumber) {
+    if (!supported) {
+        return VK_NULL_HANDLE;
+    }
+    FrameSlot& slot = slots[frameSlot % framesInFlight];
+
+    // The slot's fence has signalled, so its last submitted frame is complete and
+    // reading it cannot stall. An abandoned frame begun again was never submitted.
+    if (slot.frameNumber != 0 && slot.frameNumber != frameNumber) {
+        collectResults(slot);
+    }
+    slot.frameNumber = 0;
+    slot.queryCount = 0;
+    slot.scopes.clear();
+    currentSlot = &slot;
+
+    beginCommandBuffer(slot.beginCommands);
+    vkCmdResetQueryPool(slot.beginCommands, slot.queryPool, 0, maxQueries);
+    frameScopeToken = beginScope(slot.beginCommands, kFrameScopeName);
+    endCommandBuffer(slot.beginCommands);
+
+    slot.frameNumber = frameNumber;
+    return slot.beginCommands;
+}
+
+VkCommandBuffer GpuProfiler::endFrame() {
+    if (!supported || !currentSlot) {
+        return VK_NULL_HANDLE;
+    }
+    FrameSlot& slot = *currentSlot;
+    beginCommandBuffer(slot.endCommands);
+    endScope(slot.endCommands, frameScopeToken);
+    endCommandBuffer(slot.endCommands);
+
+    currentSlot = nullptr;
+    if (reportInterval != 0 && ++framesSinceReport >= reportInterval) {
+        framesSinceReport = 0;
+        logStats();
+    }
+    return slot.endCommands;
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name) {
+    if (!supported || !currentSlot) {
+        return UINT32_MAX;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    FrameSlot& slot = *currentSlot;
+    if (slot.queryCount + 2 > maxQueries) {
+        VG_LOG_DEBUG("GPU profiler is out of queries this frame; dropping scope ", name);
+        return UINT32_MAX;
+    }
+    uint32_t firstQuery = slot.queryCount;
+    slot.queryCount += 2;
+    slot.scopes.push_back({ findScope(name), firstQuery });
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.queryPool, firstQuery);
+    return firstQuery;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t token) {
+    if (!supported || !currentSlot || token == UINT32_MAX) {
+        return;
+    }
+    // BOTTOM_OF_PIPE: written once all work recorded before it has finished.
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentSlot->queryPool, token + 1);
+}
+
+void GpuProfiler::collectResults(FrameSlot& slot) {
+    if (slot.queryCount == 0) {
+        return;
+    }
+    std::vector<uint64_t> timestamps(slot.queryCount);
+    VkResult result = vkGetQueryPoolResults(device.getDevice(), slot.queryPool, 0, slot.queryCount,
+                                            timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    if (result == VK_NOT_READY) {
+        // A scope was begun but its end never recorded; skip the frame rather than report garbage.
+        VG_LOG_DEBUG("GPU profiler results of frame ", slot.frameNumber, " incomplete; skipped.");
+        return;
+    } else if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to read timestamp queries. VkResult: ", result);
+        throw std::runtime_error("Failed to read timestamp queries!");
+    }
+
+    double frameMs = -1.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& scope : slot.scopes) {
+            uint64_t begin = timestamps[scope.firstQuery] & timestampMask;
+            uint64_t end = timestamps[scope.firstQuery + 1] & timestampMask;
+            // Wraps within the valid bits are handled by the masked subtraction.
+            uint64_t ticks = (end - begin) & timestampMask;
+            double ms = static_cast<double>(ticks) * nanosecondsPerTick / 1e6;
+
+            ScopeHistory& entry = history[scope.scopeIndex];
+            if (entry.samples.size() < kHistorySize) {
+                entry.samples.push_back(ms);
+            } else {
+                entry.samples[entry.next] = ms;
+            }
+            entry.next = (entry.next + 1) % kHistorySize;
+            entry.lastMs = ms;
+            // beginFrame() opens the frame scope first, at query 0.
+            if (scope.firstQuery == 0) {
+                frameMs = ms;
+            }
+        }
+    }
+    if (frameMs >= 0.0 && frameTimeCallback) {
+        frameTimeCallback(frameMs);
+    }
+}
+
+uint32_t GpuProfiler::findScope(const char* name) {
+    auto it = scopeIndices.find(name);
+    if (it != scopeIndices.end()) {
+        return it->second;
+    }
+    uint32_t index = static_cast<uint32_t>(history.size());
+    history.push_back({ name, {}, 0, 0.0 });
+    history.back().samples.reserve(kHistorySize);
+    scopeIndices.emplace(name, index);
+    return index;
+}
+
+std::vector<GpuScopeStats> GpuProfiler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<GpuScopeStats> stats;
+    stats.reserve(history.size());
+    std::vector<double> sorted;
+    for (const auto& entry : history) {
+        GpuScopeStats scope;
+        scope.name = entry.name;
+        scope.sampleCount = static_cast<uint32_t>(entry.samples.size());
+        scope.lastMs = entry.lastMs;
+        if (!entry.samples.empty()) {
+            sorted = entry.samples;
+            std::sort(sorted.begin(), sorted.end());
+            double sum = 0.0;
+            for (double sample : sorted) {
+                sum += sample;
+            }
+            scope.minMs = sorted.front();
+            scope.avgMs = sum / sorted.size();
+            scope.p99Ms = sorted[(sorted.size() - 1) * 99 / 100];
+        }
+        stats.push_back(std::move(scope));
+    }
+    return stats;
+}
+
+void GpuProfiler::logStats() const {
+    for (const auto& scope : getStats()) {
+        if (scope.sampleCount == 0) {
+            continue;
+        }
+        VG_LOG_INFO("GPU ", scope.name, ": min ", scope.minMs, " ms, avg ", scope.avgMs, " ms, p99 ", scope.p99Ms,
+                    " ms (", scope.sampleCount, " frames)");
+    }
+}
+
+void GpuProfiler::beginCommandBuffer(VkCommandBuffer commandBuffer) {
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin GPU profiler command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin GPU profiler command buffer!");
+    }
+}
+
+void GpuProfiler::endCommandBuffer(VkCommandBuffer commandBuffer) {
+    VkResult result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record GPU profiler command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record GPU profiler command buffer!");
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class VulkanDevice;
+
+struct GpuScopeStats {
+    std::string name;
+    uint32_t sampleCount = 0; // Samples in the rolling window
+    double lastMs = 0.0;
+    double minMs = 0.0;
+    double avgMs = 0.0;
+    double p99Ms = 0.0;
+};
+
+/**
+ * @brief GPU timings of named scopes from timestamp queries.
+ *
+ * Each frame slot of the FrameContextRing owns a query pool. A slot's results
+ * are read when the slot is reused, after its fence has signalled, so reading
+ * never stalls. RenderPass times the whole pass as "render pass"; code that
+ * records per-frame commands (e.g. dynamic content secondaries) can add its own
+ * scopes with beginScope()/endScope(). Scopes may be recorded from several
+ * threads.
+ */
+class GpuProfiler {
+public:
+    static constexpr uint32_t kDefaultMaxScopes = 64;     // Per frame
+    static constexpr uint32_t kHistorySize = 256;         // Rolling window per scope
+    static constexpr uint32_t kDefaultReportInterval = 600;
+
+    GpuProfiler(VulkanDevice& device, uint32_t framesInFlight, uint32_t maxScopesPerFrame = kDefaultMaxScopes);
+    ~GpuProfiler();
+
+    void init();
+    void cleanup();
+
+    // False when the graphics queue has no timestamp support; every call is then a no-op.
+    bool isSupported() const { return supported; }
+
+    // Called by RenderPass once a slot's fence has signalled: collects that slot's
+    // previous results and returns a command buffer, to be submitted first, that
+    // resets the slot's queries and opens the "render pass" scope.
+    VkCommandBuffer beginFrame(uint32_t frameSlot, uint64_t frameNumber);
+    // Command buffer closing the "render pass" scope; submit it right after the pass.
+    VkCommandBuffer endFrame();
+
+    // Returns a token for endScope(), or UINT32_MAX if the frame is out of queries.
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+    void endScope(VkCommandBuffer commandBuffer, uint32_t token);
+
+    std::vector<GpuScopeStats> getStats() const;
+    void logStats() const;
+    // Frames between automatic logStats() calls; 0 disables.
+    void setReportInterval(uint32_t frames) { reportInterval = frames; }
+    // Receives each frame's "render pass" time as its results are read, a few frames late.
+    void setFrameTimeCallback(std::function<void(double ms)> callback) { frameTimeCallback = std::move(callback); }
+
+private:
+    struct RecordedScope {
+        uint32_t scopeIndex;
+        uint32_t firstQuery; // Begin timestamp; end is firstQuery + 1
+    };
+
+    struct FrameSlot {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        VkCommandBuffer beginCommands = VK_NULL_HANDLE;
+        VkCommandBuffer endCommands = VK_NULL_HANDLE;
+        uint64_t frameNumber = 0; // Frame whose results are pending; 0 = none
+        uint32_t queryCount = 0;
+        std::vector<RecordedScope> scopes;
+    };
+
+    struct ScopeHistory {
+        std::string name;
+        std::vector<double> samples; // Ring of kHistorySize
+        uint32_t next = 0;
+        double lastMs = 0.0;
+    };
+
+    void collectResults(FrameSlot& slot);
+    uint32_t findScope(const char* name);
+    void beginCommandBuffer(VkCommandBuffer commandBuffer);
+    void endCommandBuffer(VkCommandBuffer commandBuffer);
+
+    VulkanDevice& device;
+    uint32_t framesInFlight;
+    uint32_t maxQueries;
+    bool supported = false;
+    double nanosecondsPerTick = 1.0;
+    uint64_t timestampMask = ~0ull;
+    uint32_t reportInterval = kDefaultReportInterval;
+    uint64_t framesSinceReport = 0;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::vector<FrameSlot> slots;
+    FrameSlot* currentSlot = nullptr;
+    uint32_t frameScopeToken = UINT32_MAX;
+    std::function<void(double ms)> frameTimeCallback;
+
+    mutable std::mutex mutex;
+    std::vector<ScopeHistory> history;
+    std::unordered_map<std::string, uint32_t> scopeIndices;
+};
@@ -0,0 +1,139 @@
+#include "ParallelCommandRecorder.h"
+#include "VulkanDevice.h"
+#include "JobSystem.h"
+#include <stdexcept>
+
+ParallelCommandRecorder::ParallelCommandRecorder(VulkanDevice& device, JobSystem& jobSystem, uint32_t framesInFlight)
+    : device(device), jobSystem(jobSystem), framesInFlight(framesInFlight) {}
+
+ParallelCommandRecorder::~ParallelCommandRecorder() {
+    cleanup();
+}
+
+void ParallelCommandRecorder::init() {
+    threadSlots = jobSystem.getThreadSlotCount();
+    VG_LOG_INFO("Creating ", framesInFlight * threadSlots, " transient command pools for parallel recording...");
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = device.getQueueFamilyIndices().graphicsFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    pools.resize(static_cast<size_t>(framesInFlight) * threadSlots);
+    resetFrameNumbers.assign(framesInFlight, 0);
+    for (auto& threadPool : pools) {
+        VkResult result = vkCreateCommandPool(device.getDevice(), &poolInfo, nullptr, &threadPool.pool);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to create transient command pool. VkResult: ", result);
+            throw std::runtime_error("Failed to create transient command pool!");
+        }
+    }
+    VG_LOG_INFO("Transient command pools created successfully.");
+}
+
+void ParallelCommandRecorder::cleanup() {
+    if (pools.empty()) {
+        return;
+    }
+    // Destroying a pool frees its buffers; callers make sure no frame still uses them.
+    for (auto& threadPool : pools) {
+        if (threadPool.pool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device.getDevice(), threadPool.pool, nullptr);
+        }
+    }
+    pools.clear();
+    resetFrameNumbers.clear();
+    VG_LOG_INFO("Transient command pools destroyed.");
+}
+
+ParallelCommandRecorder::ThreadCommandPool& ParallelCommandRecorder::getPool(uint32_t frameSlot, uint32_t threadSlot) {
+    return pools[static_cast<size_t>(frameSlot) * threadSlots + threadSlot];
+}
+
+void ParallelCommandRecorder::resetFrameSlot(uint32_t frameSlot) {
+    for (uint32_t thread = 0; thread < threadSlots; thread++) {
+        ThreadCommandPool& threadPool = getPool(frameSlot, thread);
+        if (threadPool.used == 0) {
+            continue;
+        }
+        VkResult result = vkResetCommandPool(device.getDevice(), threadPool.pool, 0);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to reset transient command pool. VkResult: ", result);
+            throw std::runtime_error("Failed to reset transient command pool!");
+        }
+        threadPool.used = 0;
+    }
+}
+
+VkCommandBuffer ParallelCommandRecorder::acquireSecondary(ThreadCommandPool& threadPool) {
+    if (threadPool.used == threadPool.buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = threadPool.pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        VkResult result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, &commandBuffer);
+        if (result != VK_SUCCESS) {
+            VG_LOG_ERROR("Failed to allocate secondary command buffer. VkResult: ", result);
+            throw std::runtime_error("Failed to allocate secondary command buffer!");
+        }
+        threadPool.buffers.push_back(commandBuffer);
+    }
+    return threadPool.buffers[threadPool.used++];
+}
+
+void ParallelCommandRecorder::record(const FrameContext& frame, const VkCommandBufferInheritanceInfo& inheritance, size_t itemCount,
+                                     const RecordRangeCallback& recordRange, std::vector<VkCommandBuffer>& secondaries) {
+    if (itemCount == 0) {
+        return;
+    }
+    if (frame.index >= framesInFlight) {
+        VG_LOG_ERROR("Frame slot ", frame.index, " exceeds the recorder's ", framesInFlight, " frames in flight.");
+        throw std::runtime_error("Frame slot out of range for parallel recorder!");
+    }
+
+    if (resetFrameNumbers[frame.index] != frame.frameNumber) {
+        resetFrameSlot(frame.index);
+        resetFrameNumbers[frame.index] = frame.frameNumber;
+    }
+
+    size_t sliceCount = (itemCount + itemsPerBuffer - 1) / itemsPerBuffer;
+    sliceBuffers.assign(sliceCount, VK_NULL_HANDLE);
+    uint32_t frameSlot = frame.index;
+
+    // One slice per chunk so each secondary lands at a fixed position regardless of
+    // which worker recorded it, keeping draw order deterministic.
+    jobSystem.parallelFor(sliceCount, 1, [&](size_t sliceBegin, size_t sliceEnd, uint32_t threadSlot) {
+        ThreadCommandPool& threadPool = getPool(frameSlot, threadSlot);
+        for (size_t slice = sliceBegin; slice < sliceEnd; slice++) {
+            VkCommandBuffer commandBuffer = acquireSecondary(threadPool);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            beginInfo.pInheritanceInfo = &inheritance;
+
+            VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+            if (result != VK_SUCCESS) {
+                VG_LOG_ERROR("Failed to begin secondary command buffer. VkResult: ", result);
+                throw std::runtime_error("Failed to begin secondary command buffer!");
+            }
+
+            size_t begin = slice * itemsPerBuffer;
+            size_t end = begin + itemsPerBuffer < itemCount ? begin + itemsPerBuffer : itemCount;
+            recordRange(commandBuffer, begin, end);
+
+            result = vkEndCommandBuffer(commandBuffer);
+            if (result != VK_SUCCESS) {
+                VG_LOG_ERROR("Failed to record secondary command buffer. VkResult: ", result);
+                throw std::runtime_error("Failed to record secondary command buffer!");
+            }
+            sliceBuffers[slice] = commandBuffer;
+        }
+    });
+
+    secondaries.insert(secondaries.end(), sliceBuffers.begin(), sliceBuffers.end());
+    VG_LOG_TRACE("Recorded ", itemCount, " items into ", sliceCount, " secondary command buffers.");
+}
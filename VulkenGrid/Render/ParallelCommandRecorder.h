@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "FrameContext.h"
+
+class VulkanDevice;
+class JobSystem;
+
+// Records items [begin, end) into an already begun secondary command buffer.
+using RecordRangeCallback = std::function<void(VkCommandBuffer commandBuffer, size_t begin, size_t end)>;
+
+/**
+ * @brief Records secondary command buffers for slices of a draw list on the job system.
+ *
+ * Every (frame slot, thread slot) pair owns a TRANSIENT command pool, so
+ * workers never share a pool and no locking is needed while recording. A
+ * frame slot's pools are reset wholesale the first time the slot is used for
+ * a new frame, which is safe because FrameContextRing::beginFrame() has
+ * already waited on that slot's fence.
+ */
+class ParallelCommandRecorder {
+public:
+    static constexpr size_t kDefaultItemsPerBuffer = 256;
+
+    ParallelCommandRecorder(VulkanDevice& device, JobSystem& jobSystem, uint32_t framesInFlight);
+    ~ParallelCommandRecorder();
+
+    void init();
+    void cleanup();
+
+    // Splits [0, itemCount) into slices of getItemsPerBuffer(), records each slice
+    // into its own secondary on a worker and appends them to secondaries in item
+    // order. Must be called from the render thread; RenderPass does so for its
+    // draw list (RenderPass::setDrawListCallbacks).
+    void record(const FrameContext& frame, const VkCommandBufferInheritanceInfo& inheritance, size_t itemCount,
+                const RecordRangeCallback& recordRange, std::vector<VkCommandBuffer>& secondaries);
+
+    void setItemsPerBuffer(size_t count) { itemsPerBuffer = count > 0 ? count : 1; }
+    size_t getItemsPerBuffer() const { return itemsPerBuffer; }
+
+private:
+    struct ThreadCommandPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> buffers; // Allocated so far; reused after each reset
+        size_t used = 0;
+    };
+
+    ThreadCommandPool& getPool(uint32_t frameSlot, uint32_t threadSlot);
+    void resetFrameSlot(uint32_t frameSlot);
+    VkCommandBuffer acquireSecondary(ThreadCommandPool& threadPool);
+
+    VulkanDevice& device;
+    JobSystem& jobSystem;
+    uint32_t framesInFlight;
+    uint32_t threadSlots = 0;
+    size_t itemsPerBuffer = kDefaultItemsPerBuffer;
+
+    std::vector<ThreadCommandPool> pools;     // framesInFlight * threadSlots
+    std::vector<uint64_t> resetFrameNumbers;  // Frame each slot's pools were last reset for
+    std::vector<VkCommandBuffer> sliceBuffers;
+};
@@ -1,13 +1,16 @@
 #include "PipeLine.h"
 #include "VulkanDevice.h"
-#include "VulkanSwapchain.h"
-#include "ShaderModule.h"
+#include "RenderTarget.h"
+#include "PipelineLibrary.h"
+#include "PipelineCache.h"
 #include "../Utils/LoggerUtils.h"
 #include <stdexcept>
-#include <vector>
+#include <chrono>
 
-Pipeline::Pipeline(VulkanDevice& device, VulkanSwapchain& swapchain, VkRenderPass renderPass)
-    : device(device), swapchain(swapchain), renderPass(renderPass), graphicsPipeline(VK_NULL_HANDLE), pipelineLayout(VK_NULL_HANDLE) {
+Pipeline::Pipeline(VulkanDevice& device, RenderTarget& target, VkRenderPass renderPass, PipelineCache* pipelineCache,
+                   PipelineLibrary* pipelineLibrary)
+    : device(device), target(target), renderPass(renderPass), pipelineCache(pipelineCache), pipelineLibrary(pipelineLibrary),
+      graphicsPipeline(VK_NULL_HANDLE), pipelineLayout(VK_NULL_HANDLE) {
     Logger::getInstance().log("Pipeline object created.");
 }
 
@@ -15,88 +18,9 @@ Pipeline::~Pipeline() {
     cleanup();
 }
 
-void Pipeline::createGraphicsPipeline(VkExtent2D swapchainExtent) {
+void Pipeline::createGraphicsPipeline() {
     Logger::getInstance().log("Creating Graphics Pipeline...");
 
-    // Create shader modules
-    ShaderModule vertShaderModule(device.getDevice(), "shaders/triangle.vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
-    ShaderModule fragShaderModule(device.getDevice(), "shaders/triangle.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
-
-    // Shader stages
-    std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {
-        vertShaderModule.getPipelineShaderStageCreateInfo(),
-        fragShaderModule.getPipelineShaderStageCreateInfo()
-    };
-
-    // Vertex input state
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.pVertexBindingDescriptions = nullptr;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    vertexInputInfo.pVertexAttributeDescriptions = nullptr;
-
-    // Input assembly state
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    // Viewport and scissor
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(swapchainExtent.width);
-    viewport.height = static_cast<float>(swapchainExtent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = swapchainExtent;
-
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
-    viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
-
-    // Rasterizer state
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL; // Fill polygons
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT; // Cull back faces
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE; // Clockwise winding
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    // Multisampling state
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    // Color blending state
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask =
-        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable     = VK_FALSE;
-    colorBlending.logicOp           = VK_LOGIC_OP_COPY;
-    colorBlending.attachmentCount   = 1;
-    colorBlending.pAttachments      = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
-
     // Pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -110,37 +34,51 @@ void Pipeline::createGraphicsPipeline(VkExtent2D swapchainExtent) {
         throw std::runtime_error("Failed to create pipeline layout.");
     }
 
-    // Graphics pipeline creation
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount          = static_cast<uint32_t>(shaderStages.size());
-    pipelineInfo.pStages             = shaderStages.data();
-    pipelineInfo.pVertexInputState   = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState      = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState   = &multisampling;
-    pipelineInfo.pDepthStencilState  = nullptr;
-    pipelineInfo.pColorBlendState    = &colorBlending;
-    pipelineInfo.pDynamicState       = nullptr;
-    pipelineInfo.layout              = pipelineLayout;
-    pipelineInfo.renderPass          = renderPass;
-    pipelineInfo.subpass             = 0;
-    pipelineInfo.basePipelineHandle  = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex   = -1;
-
-    VkResult result = vkCreateGraphicsPipelines(device.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline);
-    if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to create Graphics Pipeline: " + std::to_string(result));
-        throw std::runtime_error("Failed to create graphics pipeline.");
+    desc = GraphicsPipelineDesc{};
+    desc.shaders = {
+        { VK_SHADER_STAGE_VERTEX_BIT, "shaders/triangle.vert.spv" },
+        { VK_SHADER_STAGE_FRAGMENT_BIT, "shaders/triangle.frag.spv" }
+    };
+    desc.cullMode = VK_CULL_MODE_BACK_BIT; // Cull back faces
+    desc.frontFace = VK_FRONT_FACE_CLOCKWISE; // Clockwise winding
+    desc.dynamicRasterState = true;
+    desc.layout = pipelineLayout;
+    desc.renderPass = renderPass;
+
+    if (pipelineLibrary) {
+        // The pass only clears until the compile finishes, instead of stalling startup on it.
+        handle = pipelineLibrary->request(desc);
+        Logger::getInstance().log("Graphics Pipeline requested from the pipeline library.");
+        return;
     }
 
+    // Timed so cold (empty cache) and warm (cache from disk) startups can be compared.
+    VkPipelineCache cache = pipelineCache ? pipelineCache->getCache() : VK_NULL_HANDLE;
+    auto compileStart = std::chrono::steady_clock::now();
+    graphicsPipeline = PipelineLibrary::compile(device, cache, desc);
+    double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+    const char* cacheState = !pipelineCache ? "no cache" : pipelineCache->isWarm() ? "warm cache" : "cold cache";
+    VG_LOG_INFO("Graphics pipeline compiled in ", compileMs, " ms (", cacheState, ").");
+
     Logger::getInstance().log("Graphics Pipeline created successfully.");
 }
 
+void Pipeline::bind(VkCommandBuffer commandBuffer) const {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, getGraphicsPipeline());
+    if (desc.dynamicRasterState && device.hasExtendedDynamicState()) {
+        device.cmdSetRasterState(commandBuffer, desc.cullMode, desc.frontFace, desc.topology);
+    }
+}
+
 void Pipeline::cleanup() {
     VkDevice logicalDevice = device.getDevice();
 
+    // The library's pipeline is keyed by the layout, so it goes with it.
+    if (handle.isValid()) {
+        pipelineLibrary->release(pipelineLayout);
+        handle = PipelineHandle();
+    }
+
     if (graphicsPipeline != VK_NULL_HANDLE) {
         vkDestroyPipeline(logicalDevice, graphicsPipeline, nullptr);
         graphicsPipeline = VK_NULL_HANDLE;
@@ -2,24 +2,37 @@
 
 #include <vulkan/vulkan.h>
 
+#include "PipelineLibrary.h"
+
 class VulkanDevice;
-class VulkanSwapchain;
+class RenderTarget;
+class PipelineCache;
 
 class Pipeline {
 public:
-    Pipeline(VulkanDevice& device, VulkanSwapchain& swapchain, VkRenderPass renderPass);
+    // With a library the pipeline is compiled off the render thread and owned by the library.
+    Pipeline(VulkanDevice& device, RenderTarget& target, VkRenderPass renderPass, PipelineCache* pipelineCache = nullptr,
+             PipelineLibrary* pipelineLibrary = nullptr);
     ~Pipeline();
 
-    void createGraphicsPipeline(VkExtent2D swapchainExtent);
+    // Viewport and scissor are dynamic, so the pipeline does not depend on the swapchain extent.
+    void createGraphicsPipeline();
     void cleanup();
 
-    VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
+    // VK_NULL_HANDLE while a library compile is still running; callers skip the draw until then.
+    VkPipeline getGraphicsPipeline() const { return pipelineLibrary ? handle.getOr(VK_NULL_HANDLE) : graphicsPipeline; }
+    // Binds the pipeline and sets any raster state it leaves dynamic.
+    void bind(VkCommandBuffer commandBuffer) const;
 
 private:
     VulkanDevice& device;
-    VulkanSwapchain& swapchain;
+    RenderTarget& target;
     VkRenderPass renderPass;
+    PipelineCache* pipelineCache;
+    PipelineLibrary* pipelineLibrary;
 
-    VkPipeline graphicsPipeline;
+    GraphicsPipelineDesc desc;
+    PipelineHandle handle;       // Library-owned pipeline
+    VkPipeline graphicsPipeline; // Owned pipeline, without a library
     VkPipelineLayout pipelineLayout;
 };
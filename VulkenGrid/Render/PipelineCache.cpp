@@ -0,0 +1,137 @@
+#include "PipelineCache.h"
+#include "VulkanDevice.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+PipelineCache::PipelineCache(VulkanDevice& device, std::string path)
+    : device(device), path(std::move(path)) {}
+
+PipelineCache::~PipelineCache() {
+    cleanup();
+}
+
+bool PipelineCache::readCacheFile(std::string& data) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !data.empty();
+}
+
+bool PipelineCache::validateHeader(const std::string& data) const {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header)) {
+        VG_LOG_WARN("Pipeline cache file is truncated; discarding it.");
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    const VkPhysicalDeviceProperties& properties = device.getProperties();
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.headerSize < sizeof(header) ||
+        header.headerSize > data.size()) {
+        VG_LOG_WARN("Pipeline cache has an unknown header layout; discarding it.");
+        return false;
+    }
+    if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID) {
+        VG_LOG_WARN("Pipeline cache was written for another GPU (vendor ", header.vendorID, ", device ", header.deviceID,
+                    "); discarding it.");
+        return false;
+    }
+    if (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        VG_LOG_WARN("Pipeline cache UUID does not match the driver (driver updated?); discarding it.");
+        return false;
+    }
+    return true;
+}
+
+void PipelineCache::init() {
+    std::string data;
+    loadedFromDisk = readCacheFile(data) && validateHeader(data);
+    if (!loadedFromDisk) {
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    VkResult result = vkCreatePipelineCache(device.getDevice(), &cacheInfo, nullptr, &pipelineCache);
+    if (result != VK_SUCCESS && loadedFromDisk) {
+        // The driver rejected data that passed our checks; start over empty.
+        VG_LOG_WARN("Driver rejected the pipeline cache data. VkResult: ", result);
+        loadedFromDisk = false;
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(device.getDevice(), &cacheInfo, nullptr, &pipelineCache);
+    }
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create pipeline cache. VkResult: ", result);
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+
+    if (loadedFromDisk) {
+        VG_LOG_INFO("Pipeline cache loaded from ", path, " (", data.size(), " bytes).");
+    } else {
+        VG_LOG_INFO("Starting with an empty pipeline cache.");
+    }
+}
+
+void PipelineCache::save() {
+    if (pipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    size_t size = 0;
+    VkResult result = vkGetPipelineCacheData(device.getDevice(), pipelineCache, &size, nullptr);
+    if (result != VK_SUCCESS || size == 0) {
+        VG_LOG_WARN("No pipeline cache data to save. VkResult: ", result);
+        return;
+    }
+    std::vector<char> data(size);
+    result = vkGetPipelineCacheData(device.getDevice(), pipelineCache, &size, data.data());
+    if (result != VK_SUCCESS) {
+        VG_LOG_WARN("Failed to read pipeline cache data. VkResult: ", result);
+        return;
+    }
+
+    // Write-then-rename so readers only ever see a complete file.
+    std::error_code error;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), error);
+    }
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(size));
+        file.close();
+        if (!file) {
+            VG_LOG_WARN("Failed to write pipeline cache to ", tempPath);
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, target, error);
+    if (error) {
+        VG_LOG_WARN("Failed to replace pipeline cache file: ", error.message());
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+    VG_LOG_INFO("Pipeline cache saved to ", path, " (", size, " bytes).");
+}
+
+void PipelineCache::cleanup() {
+    if (pipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+    save();
+    vkDestroyPipelineCache(device.getDevice(), pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
+    VG_LOG_INFO("Pipeline cache destroyed.");
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <string>
+
+class VulkanDevice;
+
+/**
+ * @brief VkPipelineCache persisted across runs.
+ *
+ * init() seeds the cache from disk when the file's header matches this
+ * device (vendorID, deviceID and pipelineCacheUUID); anything else is
+ * discarded and the cache starts empty. save() writes to a temporary file
+ * and renames it over the old one, so a crash mid-write never leaves a
+ * truncated cache behind.
+ */
+class PipelineCache {
+public:
+    PipelineCache(VulkanDevice& device, std::string path = "cache/pipeline_cache.bin");
+    ~PipelineCache();
+
+    void init();
+    void save();
+    // Saves, then destroys the cache.
+    void cleanup();
+
+    VkPipelineCache getCache() const { return pipelineCache; }
+    // True when init() found a valid cache for this device on disk.
+    bool isWarm() const { return loadedFromDisk; }
+
+private:
+    bool readCacheFile(std::string& data) const;
+    bool validateHeader(const std::string& data) const;
+
+    VulkanDevice& device;
+    std::string path;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    bool loadedFromDisk = false;
+};
@@ -0,0 +1,287 @@
+#include "PipelineLibrary.h"
+#include "PipelineCache.h"
+#include "ShaderModule.h"
+#include "VulkanDevice.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    void hashCombine(size_t& seed, size_t value) {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    template <typename T>
+    void hashValue(size_t& seed, const T& value) {
+        hashCombine(seed, std::hash<T>()(value));
+    }
+}
+
+size_t GraphicsPipelineDesc::hash() const {
+    size_t seed = 0;
+    for (const auto& shader : shaders) {
+        hashValue(seed, static_cast<uint32_t>(shader.stage));
+        hashValue(seed, shader.path);
+    }
+    for (const auto& binding : vertexBindings) {
+        hashValue(seed, binding.binding);
+        hashValue(seed, binding.stride);
+        hashValue(seed, static_cast<uint32_t>(binding.inputRate));
+    }
+    for (const auto& attribute : vertexAttributes) {
+        hashValue(seed, attribute.location);
+        hashValue(seed, attribute.binding);
+        hashValue(seed, static_cast<uint32_t>(attribute.format));
+        hashValue(seed, attribute.offset);
+    }
+    hashValue(seed, static_cast<uint32_t>(topology));
+    hashValue(seed, static_cast<uint32_t>(polygonMode));
+    hashValue(seed, static_cast<uint32_t>(cullMode));
+    hashValue(seed, static_cast<uint32_t>(frontFace));
+    hashValue(seed, blendEnable);
+    hashValue(seed, static_cast<uint32_t>(srcColorBlendFactor));
+    hashValue(seed, static_cast<uint32_t>(dstColorBlendFactor));
+    hashValue(seed, static_cast<uint32_t>(colorWriteMask));
+    hashValue(seed, dynamicRasterState);
+    hashValue(seed, reinterpret_cast<uintptr_t>(layout));
+    hashValue(seed, reinterpret_cast<uintptr_t>(renderPass));
+    hashValue(seed, subpass);
+    return seed;
+}
+
+bool GraphicsPipelineDesc::operator==(const GraphicsPipelineDesc& other) const {
+    auto sameShaders = [](const std::vector<ShaderStageDesc>& a, const std::vector<ShaderStageDesc>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].stage != b[i].stage || a[i].path != b[i].path) return false;
+        }
+        return true;
+    };
+    auto sameBindings = [](const std::vector<VkVertexInputBindingDescription>& a, const std::vector<VkVertexInputBindingDescription>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].binding != b[i].binding || a[i].stride != b[i].stride || a[i].inputRate != b[i].inputRate) return false;
+        }
+        return true;
+    };
+    auto sameAttributes = [](const std::vector<VkVertexInputAttributeDescription>& a, const std::vector<VkVertexInputAttributeDescription>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].location != b[i].location || a[i].binding != b[i].binding ||
+                a[i].format != b[i].format || a[i].offset != b[i].offset) return false;
+        }
+        return true;
+    };
+
+    return sameShaders(shaders, other.shaders) && sameBindings(vertexBindings, other.vertexBindings) &&
+           sameAttributes(vertexAttributes, other.vertexAttributes) && topology == other.topology &&
+           polygonMode == other.polygonMode && cullMode == other.cullMode && frontFace == other.frontFace &&
+           blendEnable == other.blendEnable && srcColorBlendFactor == other.srcColorBlendFactor &&
+           dstColorBlendFactor == other.dstColorBlendFactor && colorWriteMask == other.colorWriteMask &&
+           dynamicRasterState == other.dynamicRasterState && layout == other.layout &&
+           renderPass == other.renderPass && subpass == other.subpass;
+}
+
+bool PipelineHandle::isReady() const {
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+VkPipeline PipelineHandle::getOr(VkPipeline placeholder) const {
+    if (!isReady()) {
+        return placeholder;
+    }
+    VkPipeline pipeline = future.get();
+    return pipeline != VK_NULL_HANDLE ? pipeline : placeholder;
+}
+
+PipelineLibrary::PipelineLibrary(VulkanDevice& device, PipelineCache* pipelineCache, uint32_t compileThreads)
+    : device(device), pipelineCache(pipelineCache), compileJobs(compileThreads) {}
+
+PipelineLibrary::~PipelineLibrary() {
+    cleanup();
+}
+
+void PipelineLibrary::init() {
+    compileJobs.init();
+    VG_LOG_INFO("Pipeline library started with ", compileJobs.getWorkerCount(), " compile threads.");
+}
+
+void PipelineLibrary::cleanup() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (pipelines.empty()) {
+        compileJobs.cleanup();
+        return;
+    }
+
+    for (auto& entry : pipelines) {
+        VkPipeline pipeline = entry.second.get();
+        if (pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device.getDevice(), pipeline, nullptr);
+        }
+    }
+    VG_LOG_INFO("Pipeline library destroyed ", pipelines.size(), " pipelines.");
+    pipelines.clear();
+    compileJobs.cleanup();
+}
+
+size_t PipelineLibrary::getPipelineCount() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return pipelines.size();
+}
+
+void PipelineLibrary::release(VkPipelineLayout layout) {
+    std::lock_guard<std::mutex> guard(mutex);
+    size_t released = 0;
+    for (auto it = pipelines.begin(); it != pipelines.end();) {
+        if (it->first.layout != layout) {
+            ++it;
+            continue;
+        }
+        VkPipeline pipeline = it->second.get();
+        if (pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device.getDevice(), pipeline, nullptr);
+        }
+        it = pipelines.erase(it);
+        released++;
+    }
+    VG_LOG_DEBUG("Pipeline library released ", released, " pipelines of a destroyed layout.");
+}
+
+void PipelineLibrary::waitIdle() const {
+    // Waited on outside the lock so compiles that request() queues meanwhile are not held up.
+    std::vector<std::shared_future<VkPipeline>> futures;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (const auto& entry : pipelines) {
+            futures.push_back(entry.second);
+        }
+    }
+    for (const auto& future : futures) {
+        future.wait();
+    }
+}
+
+PipelineHandle PipelineLibrary::request(const GraphicsPipelineDesc& desc) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = pipelines.find(desc);
+    if (it != pipelines.end()) {
+        return PipelineHandle(it->second);
+    }
+
+    VkPipelineCache cache = pipelineCache ? pipelineCache->getCache() : VK_NULL_HANDLE;
+    VulkanDevice& targetDevice = device;
+    std::shared_future<VkPipeline> future = compileJobs.submit([&targetDevice, cache, desc]() -> VkPipeline {
+        try {
+            return compile(targetDevice, cache, desc);
+        }
+        catch (const std::exception& e) {
+            VG_LOG_ERROR("Pipeline compilation failed: ", e.what());
+            return VK_NULL_HANDLE;
+        }
+    }).share();
+
+    pipelines.emplace(desc, future);
+    VG_LOG_DEBUG("Queued pipeline compile (", pipelines.size(), " pipelines known).");
+    return PipelineHandle(future);
+}
+
+VkPipeline PipelineLibrary::compile(VulkanDevice& device, VkPipelineCache cache, const GraphicsPipelineDesc& desc) {
+    // Shader modules only need to live until the pipeline is created
+    std::vector<std::unique_ptr<ShaderModule>> modules;
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+    for (const auto& shader : desc.shaders) {
+        modules.push_back(std::make_unique<ShaderModule>(device.getDevice(), shader.path, shader.stage));
+        shaderStages.push_back(modules.back()->getPipelineShaderStageCreateInfo());
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = desc.vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = desc.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Set at record time so the pipeline survives swapchain resizes.
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr;
+
+    std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    if (desc.dynamicRasterState && device.hasExtendedDynamicState()) {
+        dynamicStates.push_back(VK_DYNAMIC_STATE_CULL_MODE_EXT);
+        dynamicStates.push_back(VK_DYNAMIC_STATE_FRONT_FACE_EXT);
+        dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT);
+    }
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = desc.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.cullMode;
+    rasterizer.frontFace = desc.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = desc.colorWriteMask;
+    colorBlendAttachment.blendEnable = desc.blendEnable ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = desc.srcColorBlendFactor;
+    colorBlendAttachment.dstColorBlendFactor = desc.dstColorBlendFactor;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineInfo.pStages = shaderStages.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = nullptr;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(device.getDevice(), cache, 1, &pipelineInfo, nullptr, &pipeline);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to create graphics pipeline. VkResult: ", result);
+        throw std::runtime_error("Failed to create graphics pipeline.");
+    }
+    return pipeline;
+}
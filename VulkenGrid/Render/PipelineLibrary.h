@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+
+class VulkanDevice;
+class PipelineCache;
+
+struct ShaderStageDesc {
+    VkShaderStageFlagBits stage;
+    std::string path; // SPIR-V file, e.g. "shaders/triangle.vert.spv"
+};
+
+// Complete, hashable description of a graphics pipeline.
+struct GraphicsPipelineDesc {
+    std::vector<ShaderStageDesc> shaders;
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    bool blendEnable = false;
+    VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    // Viewport and scissor are always dynamic. When set and the device supports
+    // extended dynamic state, cull mode, front face and topology (within its
+    // class) are dynamic too and the fields above are only recording defaults.
+    bool dynamicRasterState = false;
+    VkPipelineLayout layout = VK_NULL_HANDLE; // Owned by the caller
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+
+    size_t hash() const;
+    bool operator==(const GraphicsPipelineDesc& other) const;
+};
+
+struct GraphicsPipelineDescHasher {
+    size_t operator()(const GraphicsPipelineDesc& desc) const { return desc.hash(); }
+};
+
+// Shared handle to a pipeline that may still be compiling.
+class PipelineHandle {
+public:
+    PipelineHandle() = default;
+    explicit PipelineHandle(std::shared_future<VkPipeline> future) : future(std::move(future)) {}
+
+    bool isValid() const { return future.valid(); }
+    bool isReady() const;
+    // Blocks until compiled; VK_NULL_HANDLE if compilation failed.
+    VkPipeline get() const { return future.get(); }
+    // Never blocks: the pipeline if it is ready, otherwise placeholder.
+    VkPipeline getOr(VkPipeline placeholder) const;
+
+private:
+    std::shared_future<VkPipeline> future;
+};
+
+/**
+ * @brief Deduplicating, asynchronous graphics pipeline compiler.
+ *
+ * request() hashes the description; identical descriptions share one
+ * pipeline. New ones are compiled on the library's own worker threads
+ * (kept separate from the render job system so a long compile never
+ * delays frame work), through the shared on-disk PipelineCache.
+ */
+class PipelineLibrary {
+public:
+    PipelineLibrary(VulkanDevice& device, PipelineCache* pipelineCache = nullptr, uint32_t compileThreads = 2);
+    ~PipelineLibrary();
+
+    void init();
+    // Waits for outstanding compiles, then destroys every pipeline.
+    void cleanup();
+
+    PipelineHandle request(const GraphicsPipelineDesc& desc);
+    // Waits for and destroys every pipeline built with layout. Call before destroying the
+    // layout: entries are keyed by its handle, which the driver may hand out again.
+    void release(VkPipelineLayout layout);
+    // Blocks until every requested pipeline has compiled; for loading screens and headless runs.
+    void waitIdle() const;
+
+    // Synchronous build shared with Pipeline; throws on failure.
+    static VkPipeline compile(VulkanDevice& device, VkPipelineCache cache, const GraphicsPipelineDesc& desc);
+
+    size_t getPipelineCount() const;
+
+private:
+    VulkanDevice& device;
+    PipelineCache* pipelineCache;
+    JobSystem compileJobs;
+
+    mutable std::mutex mutex;
+    std::unordered_map<GraphicsPipelineDesc, std::shared_future<VkPipeline>, GraphicsPipelineDescHasher> pipelines;
+};
@@ -1,41 +1,50 @@
 #include "RenderPass.h"
 #include "VulkanDevice.h"
-#include "VulkanSwapchain.h"
+#include "RenderTarget.h"
 #include "PipeLine.h"
+#include "UploadManager.h"
+#include "ReadbackManager.h"
+#include "GpuProfiler.h"
+#include "TraceRecorder.h"
+#include "JobSystem.h"
 #include "../Utils/LoggerUtils.h"
 #include <stdexcept>
 
-RenderPass::RenderPass(VulkanDevice& device, VulkanSwapchain& swapchain, VkFormat swapchainImageFormat)
-    : device(device), swapchain(swapchain), renderPass(VK_NULL_HANDLE) {
-    Logger::getInstance().log("Initializing RenderPass...");
+RenderPass::RenderPass(VulkanDevice& device, RenderTarget& target, VkFormat swapchainImageFormat, uint32_t framesInFlight)
+    : device(device), target(target), renderPass(VK_NULL_HANDLE), frameRing(device, framesInFlight),
+      dynamicBuffer(device) {
+    VG_LOG_INFO("Initializing RenderPass...");
 
     // Initial device check
     if (device.getDevice() == VK_NULL_HANDLE) {
-        Logger::getInstance().logError("Device handle is null during RenderPass initialization. Aborting RenderPass creation.");
+        VG_LOG_ERROR("Device handle is null during RenderPass initialization. Aborting RenderPass creation.");
         throw std::runtime_error("Device handle is null, cannot initialize RenderPass.");
     } else {
-        Logger::getInstance().log("Device handle is valid during RenderPass initialization.");
+        VG_LOG_DEBUG("Device handle is valid during RenderPass initialization.");
     }
 
-    // Swapchain check
-    if (swapchain.getSwapchain() == VK_NULL_HANDLE) {
-        Logger::getInstance().logError("Swapchain handle is null during RenderPass initialization. Aborting RenderPass creation.");
-        throw std::runtime_error("Swapchain handle is null, cannot initialize RenderPass.");
+    // Render target check
+    if (target.getImageViews().empty()) {
+        VG_LOG_ERROR("Render target has no images during RenderPass initialization. Aborting RenderPass creation.");
+        throw std::runtime_error("Render target has no images, cannot initialize RenderPass.");
     } else {
-        Logger::getInstance().log("Swapchain handle is valid during RenderPass initialization.");
+        VG_LOG_DEBUG("Render target is valid during RenderPass initialization.");
     }
 
-    Logger::getInstance().log("Received swapchain image format: " + std::to_string(swapchainImageFormat));
+    VG_LOG_DEBUG("Received swapchain image format: ", swapchainImageFormat);
 
-    Logger::getInstance().log("Verifying swapchain image format before creating RenderPass...");
+    VG_LOG_DEBUG("Verifying swapchain image format before creating RenderPass...");
     if (swapchainImageFormat == VK_FORMAT_UNDEFINED) {
-        Logger::getInstance().logError("Swapchain image format is undefined. Aborting RenderPass creation.");
+        VG_LOG_ERROR("Swapchain image format is undefined. Aborting RenderPass creation.");
         throw std::runtime_error("Swapchain image format is undefined, cannot create RenderPass.");
     }
 
     createRenderPass(swapchainImageFormat);
     createFramebuffers();
-    createCommandBuffers();
+    frameRing.init();
+    dynamicBuffer.init();
+    imagesInFlight.assign(framebuffers.size(), VK_NULL_HANDLE);
+    createCachedCommandBuffers();
 }
 
 RenderPass::~RenderPass() {
@@ -47,7 +56,7 @@ VkRenderPass RenderPass::getRenderPass() const {
 }
 
 void RenderPass::createRenderPass(VkFormat swapchainImageFormat) {
-    Logger::getInstance().log("Creating color attachment description...");
+    VG_LOG_DEBUG("Creating color attachment description...");
 
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = swapchainImageFormat;
@@ -57,7 +66,7 @@ void RenderPass::createRenderPass(VkFormat swapchainImageFormat) {
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = target.getFinalLayout();
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -69,13 +78,22 @@ void RenderPass::createRenderPass(VkFormat swapchainImageFormat) {
     subpass.pColorAttachments = &colorAttachmentRef;
 
     // Subpass dependencies (optional but recommended)
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    VkSubpassDependency dependencies[2]{};
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    // Replaces the implicit BOTTOM_OF_PIPE one, so the final layout transition lands
+    // before later COLOR_ATTACHMENT_OUTPUT / TRANSFER barriers such as the readback copy's.
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[1].dstAccessMask = 0;
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -83,32 +101,32 @@ void RenderPass::createRenderPass(VkFormat swapchainImageFormat) {
     renderPassInfo.pAttachments = &colorAttachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = dependencies;
 
     VkDevice logicalDevice = device.getDevice();
     VkResult result = vkCreateRenderPass(logicalDevice, &renderPassInfo, nullptr, &renderPass);
     LogVulkanResult("RenderPass creation", result);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to create RenderPass. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to create RenderPass. VkResult: ", result);
         renderPass = VK_NULL_HANDLE; // Ensure handle is null
         throw std::runtime_error("Failed to create RenderPass.");
     }
 
-    Logger::getInstance().log("RenderPass created successfully.");
+    VG_LOG_INFO("RenderPass created successfully.");
 }
 
 void RenderPass::createFramebuffers() {
-    Logger::getInstance().log("Creating framebuffers...");
-    const auto& imageViews = swapchain.getSwapchainImageViews();
+    VG_LOG_DEBUG("Creating framebuffers...");
+    const auto& imageViews = target.getImageViews();
     if (imageViews.empty()) {
-        Logger::getInstance().logError("No swapchain image views available. Aborting framebuffer creation.");
-        throw std::runtime_error("No swapchain image views available, cannot create framebuffers.");
+        VG_LOG_ERROR("No render target image views available. Aborting framebuffer creation.");
+        throw std::runtime_error("No render target image views available, cannot create framebuffers.");
     }
     framebuffers.resize(imageViews.size());
 
     for (size_t i = 0; i < imageViews.size(); i++) {
-        Logger::getInstance().log("Creating framebuffer for swapchain image view index: " + std::to_string(i));
+        VG_LOG_DEBUG("Creating framebuffer for swapchain image view index: ", i);
         VkImageView attachments[] = {
             imageViews[i]
         };
@@ -118,49 +136,222 @@ void RenderPass::createFramebuffers() {
         framebufferInfo.renderPass = renderPass;
         framebufferInfo.attachmentCount = 1;
         framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = swapchain.getSwapchainExtent().width;
-        framebufferInfo.height = swapchain.getSwapchainExtent().height;
+        framebufferInfo.width = target.getExtent().width;
+        framebufferInfo.height = target.getExtent().height;
         framebufferInfo.layers = 1;
 
         VkDevice logicalDevice = device.getDevice();
         VkResult result = vkCreateFramebuffer(logicalDevice, &framebufferInfo, nullptr, &framebuffers[i]);
         if (result != VK_SUCCESS) {
-            Logger::getInstance().logError("Failed to create framebuffer at index " + std::to_string(i) + ". VkResult: " + std::to_string(result));
+            VG_LOG_ERROR("Failed to create framebuffer at index ", i, ". VkResult: ", result);
             framebuffers[i] = VK_NULL_HANDLE; // Ensure handle is null
             throw std::runtime_error("Failed to create framebuffer!");
         }
-        Logger::getInstance().log("Framebuffer created successfully at index: " + std::to_string(i));
+        VG_LOG_DEBUG("Framebuffer created successfully at index: ", i);
     }
-    Logger::getInstance().log("All framebuffers created successfully.");
+    VG_LOG_INFO("All framebuffers created successfully.");
 }
 
-void RenderPass::createCommandBuffers() {
-    Logger::getInstance().log("Allocating command buffers...");
-    commandBuffers.resize(framebuffers.size());
+void RenderPass::createCachedCommandBuffers() {
+    VG_LOG_DEBUG("Allocating cached command buffers...");
+    uint32_t count = static_cast<uint32_t>(framebuffers.size());
+    std::vector<VkCommandBuffer> primaries(count);
+    std::vector<VkCommandBuffer> secondaries(count);
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = device.getCommandPool();
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+    allocInfo.commandBufferCount = count;
 
-    VkResult result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, commandBuffers.data());
+    VkResult result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, primaries.data());
+    if (result == VK_SUCCESS) {
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        result = vkAllocateCommandBuffers(device.getDevice(), &allocInfo, secondaries.data());
+        if (result != VK_SUCCESS) {
+            vkFreeCommandBuffers(device.getDevice(), device.getCommandPool(), count, primaries.data());
+        }
+    }
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to allocate command buffers. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to allocate command buffers. VkResult: ", result);
         throw std::runtime_error("Failed to allocate command buffers!");
     }
-    Logger::getInstance().log("Command buffers allocated successfully.");
+
+    cachedCommandBuffers.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        cachedCommandBuffers[i].primary = primaries[i];
+        cachedCommandBuffers[i].secondary = secondaries[i];
+    }
+    VG_LOG_INFO("Command buffers allocated successfully.");
+}
+
+void RenderPass::freeCachedCommandBuffers(std::vector<CachedCommandBuffer>& buffers) {
+    for (auto& cached : buffers) {
+        VkCommandBuffer commandBuffers[] = { cached.primary, cached.secondary };
+        vkFreeCommandBuffers(device.getDevice(), device.getCommandPool(), 2, commandBuffers);
+    }
+    buffers.clear();
+}
+
+bool RenderPass::recreateSwapchain(uint64_t retireAfterFrame) {
+    VkFormat previousFormat = target.getImageFormat();
+    if (!target.recreate(retireAfterFrame)) {
+        return false;
+    }
+    // The render pass, and every pipeline built against it, depends on the format.
+    if (target.getImageFormat() != previousFormat) {
+        VG_LOG_ERROR("Render target format changed from ", previousFormat, " to ", target.getImageFormat(), " on recreation.");
+        throw std::runtime_error("Render target format changed on recreation!");
+    }
+
+    // Frames still in flight may be using the old framebuffers and command buffers.
+    retiredResources.push_back({ retireAfterFrame, std::move(framebuffers), std::move(cachedCommandBuffers) });
+    framebuffers.clear();
+    cachedCommandBuffers.clear();
+
+    createFramebuffers();
+    createCachedCommandBuffers();
+    imagesInFlight.assign(framebuffers.size(), VK_NULL_HANDLE);
+    swapchainDirty = false;
+    return true;
+}
+
+void RenderPass::destroyRetiredResources(uint64_t completedFrameNumber) {
+    while (!retiredResources.empty() && retiredResources.front().retireAfterFrame <= completedFrameNumber) {
+        RetiredResources& retired = retiredResources.front();
+        for (auto framebuffer : retired.framebuffers) {
+            vkDestroyFramebuffer(device.getDevice(), framebuffer, nullptr);
+        }
+        freeCachedCommandBuffers(retired.commandBuffers);
+        retiredResources.pop_front();
+    }
+    target.destroyRetired(completedFrameNumber);
+}
+
+void RenderPass::invalidateCommandBuffers() {
+    for (auto& cached : cachedCommandBuffers) {
+        cached.valid = false;
+    }
+}
+
+VkCommandBuffer RenderPass::getCachedCommandBuffer(uint32_t imageIndex, Pipeline* pipeline) {
+    CachedCommandBuffer& cached = cachedCommandBuffers[imageIndex];
+    VkExtent2D extent = target.getExtent();
+    VkPipeline graphicsPipeline = pipeline->getGraphicsPipeline();
+
+    if (cached.valid && cached.pipeline == graphicsPipeline && cached.framebuffer == framebuffers[imageIndex] &&
+        cached.extent.width == extent.width && cached.extent.height == extent.height) {
+        VG_LOG_TRACE("Replaying cached command buffer for image index: ", imageIndex);
+        return cached.primary;
+    }
+
+    // Safe to re-record: drawFrame has already waited for the last frame that used this image.
+    VG_LOG_DEBUG("Recording cached command buffers for image index: ", imageIndex);
+    recordStaticCommands(cached.secondary, imageIndex, pipeline);
+    recordCommandBuffer(cached.primary, imageIndex, { cached.secondary });
+
+    cached.pipeline = graphicsPipeline;
+    cached.framebuffer = framebuffers[imageIndex];
+    cached.extent = extent;
+    cached.valid = true;
+    return cached.primary;
+}
+
+void RenderPass::recordStaticCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex, Pipeline* pipeline) {
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = framebuffers[imageIndex];
+
+    // Executed both by the cached primary and by dynamic frames, hence SIMULTANEOUS_USE.
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to begin recording static command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to begin recording command buffer!");
+    }
+
+    // A pipeline still compiling leaves the pass empty; the cache is re-recorded once it is ready.
+    if (pipeline->getGraphicsPipeline() != VK_NULL_HANDLE) {
+        pipeline->bind(commandBuffer);
+        setViewportAndScissor(commandBuffer);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to record static command buffer. VkResult: ", result);
+        throw std::runtime_error("Failed to record command buffer!");
+    }
+}
+
+void RenderPass::setViewportAndScissor(VkCommandBuffer commandBuffer) const {
+    VkExtent2D extent = target.getExtent();
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = { 0, 0 };
+    scissor.extent = extent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+VkExtent2D RenderPass::getExtent() const {
+    return target.getExtent();
+}
+
+void RenderPass::setJobSystem(JobSystem* jobSystem) {
+    if (commandRecorder) {
+        commandRecorder->cleanup();
+        commandRecorder.reset();
+    }
+    if (jobSystem) {
+        commandRecorder = std::make_unique<ParallelCommandRecorder>(device, *jobSystem, frameRing.getFramesInFlight());
+        commandRecorder->init();
+    } else if (drawListCount) {
+        VG_LOG_WARN("Job system removed while a draw list is set; the draw list is dropped.");
+        drawListCount = nullptr;
+        drawListRecord = nullptr;
+    }
+}
+
+void RenderPass::setUploadManager(UploadManager* manager) {
+    if (uploadManager && uploadManager != manager) {
+        uploadManager->setReaderTimeline(VK_NULL_HANDLE, 0);
+    }
+    uploadManager = manager;
+}
+
+void RenderPass::setDrawListCallbacks(DrawListCallback countItems, RecordRangeCallback recordRange) {
+    if (countItems && !commandRecorder) {
+        VG_LOG_ERROR("Draw list set on a RenderPass without a job system.");
+        throw std::runtime_error("Draw lists need a job system; call setJobSystem first!");
+    }
+    drawListCount = std::move(countItems);
+    drawListRecord = std::move(recordRange);
 }
 
-void RenderPass::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, Pipeline* pipeline) {
-    Logger::getInstance().log("Recording command buffer for image index: " + std::to_string(imageIndex));
+void RenderPass::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, const std::vector<VkCommandBuffer>& secondaries) {
+    VG_LOG_TRACE("Recording command buffer for image index: ", imageIndex);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
     VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to begin recording command buffer. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to begin recording command buffer. VkResult: ", result);
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
 
@@ -169,121 +360,253 @@ void RenderPass::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t ima
     renderPassInfo.renderPass = renderPass;
     renderPassInfo.framebuffer = framebuffers[imageIndex];
     renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = swapchain.getSwapchainExtent();
+    renderPassInfo.renderArea.extent = target.getExtent();
 
     VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
     renderPassInfo.clearValueCount = 1;
     renderPassInfo.pClearValues = &clearColor;
 
-    Logger::getInstance().log("Beginning render pass for command buffer...");
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    Logger::getInstance().log("Render pass begun for command buffer.");
-
-    // Bind the graphics pipeline
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getGraphicsPipeline());
-
-    // Record draw commands
-    Logger::getInstance().log("Recording draw commands...");
-    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-    Logger::getInstance().log("Draw command recorded.");
-
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
     vkCmdEndRenderPass(commandBuffer);
-    Logger::getInstance().log("Render pass ended for command buffer.");
 
     result = vkEndCommandBuffer(commandBuffer);
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to record command buffer. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to record command buffer. VkResult: ", result);
         throw std::runtime_error("Failed to record command buffer!");
     }
-    Logger::getInstance().log("Command buffer recorded successfully.");
+    VG_LOG_TRACE("Command buffer recorded successfully.");
 }
 
-void RenderPass::drawFrame(Pipeline* pipeline) {
-    Logger::getInstance().log("Drawing frame...");
+bool RenderPass::drawFrame(Pipeline* pipeline) {
+    VG_TRACE_SCOPE("RenderPass::drawFrame");
+    VG_LOG_TRACE("Drawing frame...");
+
+    // Blocks only if the CPU is a full ring ahead of the GPU.
+    FrameContext& frame = frameRing.beginFrame();
+    dynamicBuffer.beginFrame(frame.frameNumber, frameRing.getCompletedFrameNumber());
+    destroyRetiredResources(frameRing.getCompletedFrameNumber());
+    if (readbackManager) {
+        readbackManager->poll(frameRing.getCompletedFrameNumber());
+    }
+
+    // Only frames before this one can still reference the current swapchain, so
+    // no device-wide wait is needed; the old resources retire with those frames.
+    if (swapchainDirty && !recreateSwapchain(frame.frameNumber - 1)) {
+        // Zero-sized surface; the frame is begun again once there is something to draw to.
+        return false;
+    }
+
     uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device.getDevice(), swapchain.getSwapchain(), UINT64_MAX, swapchain.getImageAvailableSemaphore(), VK_NULL_HANDLE, &imageIndex);
+    VkResult result;
+    {
+        VG_TRACE_SCOPE("acquire");
+        result = target.acquireNextImage(frame.imageAvailableSemaphore, imageIndex);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        Logger::getInstance().log("Swapchain is out of date, needs recreation.");
-        // Handle swapchain recreation
-        return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        Logger::getInstance().logError("Failed to acquire swap chain image. VkResult: " + std::to_string(result));
+        VG_LOG_DEBUG("Swapchain is out of date; recreating before the next frame.");
+        swapchainDirty = true;
+        return false;
+    } else if (result == VK_SUBOPTIMAL_KHR) {
+        // The image is still presentable; finish this frame and rebuild for the next one.
+        swapchainDirty = true;
+    } else if (result != VK_SUCCESS) {
+        VG_LOG_ERROR("Failed to acquire swap chain image. VkResult: ", result);
         throw std::runtime_error("Failed to acquire swap chain image!");
     }
 
-    Logger::getInstance().log("Image acquired successfully. Recording command buffer...");
-    recordCommandBuffer(commandBuffers[imageIndex], imageIndex, pipeline);
+    // The swapchain may hand back an image that an older frame slot is still rendering to.
+    if (imagesInFlight[imageIndex] != VK_NULL_HANDLE && imagesInFlight[imageIndex] != frame.inFlightFence) {
+        VG_TRACE_SCOPE("wait for image");
+        vkWaitForFences(device.getDevice(), 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+    }
+    imagesInFlight[imageIndex] = frame.inFlightFence;
+
+    VkCommandBuffer submitBuffer;
+    VkCommandBuffer profilerBegin;
+    VkCommandBuffer prePassBuffer;
+    {
+        VG_TRACE_SCOPE("record");
+        submitBuffer = getCachedCommandBuffer(imageIndex, pipeline);
+        // Begun before the dynamic content so its callback can record scopes too.
+        profilerBegin = gpuProfiler ? gpuProfiler->beginFrame(frame.index, frame.frameNumber) : VK_NULL_HANDLE;
+        prePassBuffer = prePassCallback ? prePassCallback(frame) : VK_NULL_HANDLE;
+
+        // Frames with dynamic content get a fresh primary that runs the cached static
+        // secondary followed by whatever the callbacks recorded.
+        if (dynamicContentCallback || drawListCount) {
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.renderPass = renderPass;
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = framebuffers[imageIndex];
+
+            frameSecondaries.clear();
+            frameSecondaries.push_back(cachedCommandBuffers[imageIndex].secondary);
+            if (dynamicContentCallback) {
+                dynamicContentCallback(frame, inheritanceInfo, frameSecondaries);
+            }
+            if (drawListCount) {
+                size_t itemCount = drawListCount(frame);
+                VG_TRACE_SCOPE("record draw list");
+                commandRecorder->record(frame, inheritanceInfo, itemCount, drawListRecord, frameSecondaries);
+            }
+            if (frameSecondaries.size() > 1) {
+                recordCommandBuffer(frame.commandBuffer, imageIndex, frameSecondaries);
+                submitBuffer = frame.commandBuffer;
+            }
+        }
+    }
 
     // Submit the command buffer
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = { swapchain.getImageAvailableSemaphore() };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
+    // Offscreen images are never handed out by a presentation engine, so there is nothing to wait for.
+    VkSemaphore waitSemaphores[2];
+    VkPipelineStageFlags waitStages[2];
+    uint64_t waitValues[2] = { 0, 0 }; // Binary semaphore values are ignored
+    uint32_t waitCount = 0;
+    if (target.isPresentable()) {
+        waitSemaphores[waitCount] = frame.imageAvailableSemaphore;
+        waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        waitCount++;
+    }
+
+    // Small per-frame deltas are copied at the head of this frame on the graphics queue, so
+    // they never hold it back; anything else comes over from the transfer queue without a CPU wait.
+    VkCommandBuffer uploadBuffer = VK_NULL_HANDLE;
+    if (uploadManager) {
+        // Names the timeline before the first frame too, so staging of inline copies is not recycled early.
+        uploadManager->setReaderTimeline(frameRing.getTimelineSemaphore(), frame.frameNumber - 1);
+        if (uploadManager->recordInline(frame.uploadCommandBuffer, frame.frameNumber)) {
+            uploadBuffer = frame.uploadCommandBuffer;
+        }
+        uint64_t uploadValue = uploadManager->flush();
+        if (uploadValue > waitedUploadValue) {
+            waitSemaphores[waitCount] = uploadManager->getTimelineSemaphore();
+            waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            waitValues[waitCount] = uploadValue;
+            waitCount++;
+            waitedUploadValue = uploadValue;
+        }
+    }
+    submitInfo.waitSemaphoreCount = waitCount;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
-
-    VkSemaphore signalSemaphores[] = { swapchain.getRenderFinishedSemaphore() };
-    submitInfo.signalSemaphoreCount = 1;
+    // Profiler timestamps bracket the pre-pass work and the pass; the capture copy
+    // runs after them in the same submit, so everything is covered by the frame's fence.
+    VkCommandBuffer submitBuffers[6];
+    submitInfo.commandBufferCount = 0;
+    if (uploadBuffer != VK_NULL_HANDLE) {
+        submitBuffers[submitInfo.commandBufferCount++] = uploadBuffer;
+    }
+    if (profilerBegin != VK_NULL_HANDLE) {
+        submitBuffers[submitInfo.commandBufferCount++] = profilerBegin;
+    }
+    if (prePassBuffer != VK_NULL_HANDLE) {
+        submitBuffers[submitInfo.commandBufferCount++] = prePassBuffer;
+    }
+    submitBuffers[submitInfo.commandBufferCount++] = submitBuffer;
+    if (profilerBegin != VK_NULL_HANDLE) {
+        submitBuffers[submitInfo.commandBufferCount++] = gpuProfiler->endFrame();
+    }
+    if (readbackManager && readbackManager->hasCallback()) {
+        VkCommandBuffer copyBuffer = readbackManager->recordCopy(frame.frameNumber, target.getImage(imageIndex), target.getFinalLayout(),
+                                                                 target.getExtent(), target.getImageFormat());
+        if (copyBuffer != VK_NULL_HANDLE) {
+            submitBuffers[submitInfo.commandBufferCount++] = copyBuffer;
+        }
+    }
+    submitInfo.pCommandBuffers = submitBuffers;
+
+    // The frame timeline lets the next upload flush wait for this frame's reads.
+    VkSemaphore signalSemaphores[2];
+    uint64_t signalValues[2] = { 0, 0 };
+    submitInfo.signalSemaphoreCount = 0;
+    if (target.isPresentable()) {
+        signalSemaphores[submitInfo.signalSemaphoreCount++] = frame.renderFinishedSemaphore;
+    }
+    signalSemaphores[submitInfo.signalSemaphoreCount] = frameRing.getTimelineSemaphore();
+    signalValues[submitInfo.signalSemaphoreCount++] = frame.frameNumber;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    result = vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+    submitInfo.pNext = &timelineInfo;
+
+    dynamicBuffer.flush();
+
+    // Reset only once we are certain to submit, otherwise the next wait on this slot would hang.
+    vkResetFences(device.getDevice(), 1, &frame.inFlightFence);
+    {
+        VG_TRACE_SCOPE("submit");
+        result = vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, frame.inFlightFence);
+    }
     if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to submit draw command buffer. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to submit draw command buffer. VkResult: ", result);
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
+    if (uploadManager) {
+        uploadManager->setReaderTimeline(frameRing.getTimelineSemaphore(), frame.frameNumber);
+    }
+    frameRing.endFrame();
 
     // Present the image
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
-
-    VkSwapchainKHR swapchains[] = { swapchain.getSwapchain() };
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapchains;
-    presentInfo.pImageIndices = &imageIndex;
-
-    result = vkQueuePresentKHR(device.getPresentQueue(), &presentInfo);
+    {
+        VG_TRACE_SCOPE("present");
+        result = target.present(device.getPresentQueue(), frame.renderFinishedSemaphore, imageIndex);
+    }
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-        Logger::getInstance().log("Swapchain is out of date or suboptimal, needs recreation.");
-        // Handle swapchain recreation
-        return;
+        VG_LOG_DEBUG("Swapchain is out of date or suboptimal; recreating before the next frame.");
+        swapchainDirty = true;
+        return result == VK_SUBOPTIMAL_KHR;
     } else if (result != VK_SUCCESS) {
-        Logger::getInstance().logError("Failed to present swap chain image. VkResult: " + std::to_string(result));
+        VG_LOG_ERROR("Failed to present swap chain image. VkResult: ", result);
         throw std::runtime_error("Failed to present swap chain image!");
     }
 
-    Logger::getInstance().log("Frame drawn successfully.");
+    VG_LOG_TRACE("Frame drawn successfully.");
+    return true;
 }
 
 void RenderPass::cleanup() {
     VkDevice logicalDevice = device.getDevice();
 
+    // Waits for in-flight frames before their semaphores and command buffers go away.
+    frameRing.cleanup();
+    dynamicBuffer.cleanup();
+    if (commandRecorder) {
+        commandRecorder->cleanup();
+    }
+    imagesInFlight.clear();
+    destroyRetiredResources(UINT64_MAX);
+    freeCachedCommandBuffers(cachedCommandBuffers);
+
     if (renderPass != VK_NULL_HANDLE) {
-        Logger::getInstance().log("Destroying RenderPass...");
+        VG_LOG_DEBUG("Destroying RenderPass...");
         vkDestroyRenderPass(logicalDevice, renderPass, nullptr);
         renderPass = VK_NULL_HANDLE;
-        Logger::getInstance().log("RenderPass destroyed successfully.");
+        VG_LOG_INFO("RenderPass destroyed successfully.");
     } else {
-        Logger::getInstance().log("RenderPass destruction skipped (already null).");
+        VG_LOG_DEBUG("RenderPass destruction skipped (already null).");
     }
 
     for (auto& framebuffer : framebuffers) {
         if (framebuffer != VK_NULL_HANDLE) {
-            Logger::getInstance().log("Destroying framebuffer...");
+            VG_LOG_DEBUG("Destroying framebuffer...");
             vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
             framebuffer = VK_NULL_HANDLE;
         } else {
-            Logger::getInstance().log("Framebuffer destruction skipped (already null).");
+            VG_LOG_DEBUG("Framebuffer destruction skipped (already null).");
         }
     }
     framebuffers.clear();
-    Logger::getInstance().log("Framebuffers destroyed successfully.");
+    VG_LOG_INFO("Framebuffers destroyed successfully.");
 }
@@ -2,31 +2,141 @@
 
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "FrameContext.h"
+#include "DynamicRingBuffer.h"
+#include "ParallelCommandRecorder.h"
 
 class VulkanDevice;
-class VulkanSwapchain;
+class RenderTarget;
 class Pipeline;
+class UploadManager;
+class ReadbackManager;
+class GpuProfiler;
+class JobSystem;
+
+// Appends per-frame secondary command buffers for the pass. Secondaries must be
+// begun with RENDER_PASS_CONTINUE and the given inheritance info, and must call
+// RenderPass::setViewportAndScissor since dynamic state is not inherited.
+// Appending nothing keeps the frame on the cached static path.
+using DynamicContentCallback = std::function<void(FrameContext& frame, const VkCommandBufferInheritanceInfo& inheritance,
+                                                  std::vector<VkCommandBuffer>& secondaries)>;
+
+// Returns a primary command buffer recorded for this frame's slot that must run
+// before the pass (e.g. a compute culling dispatch), or VK_NULL_HANDLE for none.
+// It is submitted with the frame and ordered against the pass by its own barriers.
+using PrePassCallback = std::function<VkCommandBuffer(FrameContext& frame)>;
+
+// Returns how many draw-list items the pass draws this frame. The items are then
+// recorded in slices by a RecordRangeCallback on the job system's threads, each
+// slice into its own secondary, after any dynamic content. The range callback
+// runs concurrently and must set its own pipeline, viewport and scissor.
+using DrawListCallback = std::function<size_t(FrameContext& frame)>;
 
 class RenderPass {
 public:
-    RenderPass(VulkanDevice& device, VulkanSwapchain& swapchain, VkFormat swapchainImageFormat);
+    // Windowed (VulkanSwapchain) and headless (OffscreenTarget) rendering share this class.
+    RenderPass(VulkanDevice& device, RenderTarget& target, VkFormat swapchainImageFormat,
+               uint32_t framesInFlight = FrameContextRing::kDefaultFramesInFlight);
     ~RenderPass();
 
     VkRenderPass getRenderPass() const;
 
-    void drawFrame(Pipeline* pipeline);
+    // Returns true if the frame was presented.
+    bool drawFrame(Pipeline* pipeline);
+
+    FrameContextRing& getFrameRing() { return frameRing; }
+    // Per-frame streaming memory; allocations stay valid until their frame retires.
+    DynamicRingBuffer& getDynamicBuffer() { return dynamicBuffer; }
+
+    // Full-framebuffer viewport and scissor; every secondary that draws must set them.
+    void setViewportAndScissor(VkCommandBuffer commandBuffer) const;
+    VkExtent2D getExtent() const;
+
+    void setDynamicContentCallback(DynamicContentCallback callback) { dynamicContentCallback = std::move(callback); }
+    void setPrePassCallback(PrePassCallback callback) { prePassCallback = std::move(callback); }
+
+    // Workers for draw-list recording; nullptr releases them. Only change it
+    // while no frame is in flight, since their command pools are freed.
+    void setJobSystem(JobSystem* jobSystem);
+    // Requires a job system. Pass nullptr callbacks to remove the draw list.
+    void setDrawListCallbacks(DrawListCallback countItems, RecordRangeCallback recordRange);
+    ParallelCommandRecorder* getCommandRecorder() { return commandRecorder.get(); }
+
+    // Uploads are taken once per frame: small ones are recorded ahead of the frame's own work,
+    // the rest are flushed to the transfer queue and the frame's submit waits for them on the GPU.
+    // A replaced manager stops waiting on this pass's frames.
+    void setUploadManager(UploadManager* manager);
+
+    // While the manager has a callback, every frame's image is copied into it
+    // as part of the frame's submit; completed captures are polled each frame.
+    void setReadbackManager(ReadbackManager* manager) { readbackManager = manager; }
+
+    // Times each frame's pass on the GPU. Dynamic content callbacks may add
+    // their own scopes to the profiler while it is set.
+    void setGpuProfiler(GpuProfiler* profiler) { gpuProfiler = profiler; }
+
+    // Forces every cached command buffer to be re-recorded on next use.
+    void invalidateCommandBuffers();
+
+    // Rebuilds the target's images at the start of the next frame (e.g. after a
+    // window resize). Out-of-date and suboptimal results request this automatically.
+    void requestSwapchainRecreate() { swapchainDirty = true; }
 
     void cleanup();
 
 private:
     void createRenderPass(VkFormat swapchainImageFormat);
     void createFramebuffers();
-    void createCommandBuffers();
-    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, Pipeline* pipeline);
+    void createCachedCommandBuffers();
+    VkCommandBuffer getCachedCommandBuffer(uint32_t imageIndex, Pipeline* pipeline);
+    void recordStaticCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex, Pipeline* pipeline);
+    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, const std::vector<VkCommandBuffer>& secondaries);
+    bool recreateSwapchain(uint64_t retireAfterFrame);
+    void destroyRetiredResources(uint64_t completedFrameNumber);
+
+    // Static content for one framebuffer, recorded once and replayed until the
+    // pipeline, framebuffer or extent it was recorded against changes.
+    struct CachedCommandBuffer {
+        VkCommandBuffer primary = VK_NULL_HANDLE;    // Whole pass; submitted as-is on static frames
+        VkCommandBuffer secondary = VK_NULL_HANDLE;  // Static draws; also executed by dynamic frames
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        VkExtent2D extent{ 0, 0 };
+        bool valid = false;
+    };
+
+    // Per-image resources of replaced target images, destroyed once the last frame using them completes.
+    struct RetiredResources {
+        uint64_t retireAfterFrame;
+        std::vector<VkFramebuffer> framebuffers;
+        std::vector<CachedCommandBuffer> commandBuffers;
+    };
+
+    void freeCachedCommandBuffers(std::vector<CachedCommandBuffer>& buffers);
 
     VulkanDevice& device;
-    VulkanSwapchain& swapchain;
+    RenderTarget& target;
     VkRenderPass renderPass;
     std::vector<VkFramebuffer> framebuffers;
-    std::vector<VkCommandBuffer> commandBuffers;
+    FrameContextRing frameRing;
+    DynamicRingBuffer dynamicBuffer;
+    // Fence of the frame that last rendered to each swapchain image.
+    std::vector<VkFence> imagesInFlight;
+    std::vector<CachedCommandBuffer> cachedCommandBuffers;
+    DynamicContentCallback dynamicContentCallback;
+    PrePassCallback prePassCallback;
+    std::unique_ptr<ParallelCommandRecorder> commandRecorder;
+    DrawListCallback drawListCount;
+    RecordRangeCallback drawListRecord;
+    std::vector<VkCommandBuffer> frameSecondaries;
+    UploadManager* uploadManager = nullptr;
+    ReadbackManager* readbackManager = nullptr;
+    GpuProfiler* gpuProfiler = nullptr;
+    uint64_t waitedUploadValue = 0; // Highest upload timeline value a submit already waited for
+    bool swapchainDirty = false;
+    std::deque<RetiredResources> retiredResources;
 };
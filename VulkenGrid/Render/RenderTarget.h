@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Set of color images a RenderPass draws into: a window swapchain or offscreen images.
+ *
+ * Presentable targets hand images out and back through semaphores and the
+ * present queue. Offscreen targets have their images ready immediately, so
+ * frames rendered into them neither wait on nor signal any semaphore.
+ */
+class RenderTarget {
+public:
+    virtual ~RenderTarget() = default;
+
+    virtual VkFormat getImageFormat() const = 0;
+    virtual VkExtent2D getExtent() const = 0;
+    virtual const std::vector<VkImageView>& getImageViews() const = 0;
+    virtual VkImage getImage(uint32_t imageIndex) const = 0;
+    // Layout the render pass leaves each image in.
+    virtual VkImageLayout getFinalLayout() const = 0;
+
+    virtual bool isPresentable() const = 0;
+    // Same results as vkAcquireNextImageKHR; imageAvailable is only signalled by presentable targets.
+    virtual VkResult acquireNextImage(VkSemaphore imageAvailable, uint32_t& imageIndex) = 0;
+    // Same results as vkQueuePresentKHR; offscreen targets only record the image as the latest frame.
+    virtual VkResult present(VkQueue queue, VkSemaphore renderFinished, uint32_t imageIndex) = 0;
+
+    // Rebuilds the images for the current size. Old images stay alive until
+    // destroyRetired() sees retireAfterFrame complete. Returns false if the
+    // target cannot be rebuilt right now (e.g. a minimized window).
+    virtual bool recreate(uint64_t retireAfterFrame) = 0;
+    virtual void destroyRetired(uint64_t completedFrameNumber) = 0;
+};
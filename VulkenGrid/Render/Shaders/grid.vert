@@ -0,0 +1,37 @@
+#version 450
+
+// Must match GridInstance in Grid/GridTypes.h.
+struct GridInstance {
+    vec2 position;
+    uint color;
+    uint state;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    GridInstance instances[];
+};
+
+layout(push_constant) uniform GridView {
+    vec2 scale;
+    vec2 offset;
+    float cellSize;
+} view;
+
+layout(location = 0) out vec4 outColor;
+
+const uint kGridCellHidden = 0x80000000u;
+const uint kGridCellLevelShift = 24u;
+const uint kGridCellLevelMask = 0x0F000000u;
+
+void main() {
+    GridInstance cell = instances[gl_InstanceIndex];
+    // Quad corner from the index buffer (0, 1, 2, 2, 1, 3): bit 0 is x, bit 1 is y.
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+    float size = view.cellSize * float(1u << ((cell.state & kGridCellLevelMask) >> kGridCellLevelShift));
+    vec2 world = cell.position + corner * size;
+    gl_Position = vec4(world * view.scale + view.offset, 0.0, 1.0);
+    if ((cell.state & kGridCellHidden) != 0u) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0); // Outside the clip volume, so the quad is dropped
+    }
+    outColor = unpackUnorm4x8(cell.color);
+}
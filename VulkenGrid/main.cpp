@@ -1,5 +1,8 @@
 #include <iostream>
+#include <chrono>
+#include <fstream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #define GLFW_INCLUDE_VULKAN
@@ -8,18 +11,72 @@
 #include "VulkanInstance.h"
 #include "VulkanDevice.h"
 #include "VulkanSwapChain.h"
+#include "OffscreenTarget.h"
+#include "ReadbackManager.h"
+#include "UploadManager.h"
+#include "GridRenderer.h"
+#include "GridDataStore.h"
+#include "GridLodPyramid.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
+#include "TraceRecorder.h"
+#include "FrameStats.h"
 #include "RenderPass.h"
 #include "PipeLine.h"
+#include "PipelineCache.h"
+#include "PipelineLibrary.h"
+#include "PresentationPolicy.h"
+#include "FrameLimiter.h"
 #include "Logger.h"
 #include "SystemInfo.h"
 
 #include "../Utils/LoggerUtils.h"
 
-void mainLoop(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, Pipeline* pipeline, RenderPass* renderPass);
-void cleanup(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, Pipeline* pipeline, RenderPass* renderPass);
+// --grid=WxH draws a W by H cell grid through GridRenderer on top of the triangle;
+// --no-grid-cull draws every cell instead of culling them on the GPU first;
+// --grid-lod draws coarser aggregated cells as the view zooms out;
+// --grid-lod-max does too, but keeps each channel's brightest cell instead of the average.
+struct GridOptions {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool culling = true;
+    bool lod = false;
+    GridLodMode lodMode = GridLodMode::Average;
 
-int main() {
+    bool enabled() const { return width > 0 && height > 0; }
+};
+
+GridOptions parseGridOptions(int argc, char** argv);
+void attachDemoGrid(const GridOptions& options, RenderPass& renderPass, UploadManager& uploadManager, GridLodPyramid& pyramid,
+                    GridRenderer& grid);
+void animateDemoGrid(GridLodPyramid& pyramid, UploadManager& uploadManager, const GridRenderer& grid, uint64_t frame);
+
+void mainLoop(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, Pipeline* pipeline, RenderPass* renderPass,
+              PipelineCache& pipelineCache, PipelineLibrary& pipelineLibrary, const PresentationSettings& presentation,
+              const GridOptions& gridOptions);
+void cleanup(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, PipelineCache& pipelineCache,
+             PipelineLibrary& pipelineLibrary, Pipeline* pipeline, RenderPass* renderPass);
+
+// --headless [--frames=N] [--size=WxH] [--output=file.ppm] [--readback]
+struct HeadlessOptions {
+    bool enabled = false;
+    bool streamReadback = false; // Checksum every frame through ReadbackManager
+    uint32_t frameCount = 60;
+    VkExtent2D extent{ 800, 600 };
+    std::string outputPath; // Last frame is written here as a PPM when set
+};
+
+HeadlessOptions parseHeadlessOptions(int argc, char** argv);
+int runHeadless(const HeadlessOptions& options, const PresentationSettings& presentation, const GridOptions& gridOptions);
+
+int main(int argc, char** argv) {
+    // Keep file I/O off the render thread; records are batched by the logger's writer thread.
+    Logger::getInstance().setMode(LogMode::Asynchronous, LogOverflowPolicy::Drop);
     Logger::getInstance().log("Application started.");
+    TraceRecorder::getInstance().setThreadName("Main thread");
+
+    PresentationSettings presentation = loadPresentationSettings(argc, argv);
+    GridOptions gridOptions = parseGridOptions(argc, argv);
 
     // Log system info before any Vulkan setup
     try {
@@ -37,6 +94,12 @@ int main() {
         return -1;
     }
 
+    // No window, surface or swapchain: render offscreen and exit
+    HeadlessOptions headlessOptions = parseHeadlessOptions(argc, argv);
+    if (headlessOptions.enabled) {
+        return runHeadless(headlessOptions, presentation, gridOptions);
+    }
+
     // Initialize GLFW
     if (!glfwInit()) {
         Logger::getInstance().logError("Failed to initialize GLFW.");
@@ -94,52 +157,220 @@ int main() {
     Logger::getInstance().log("Vulkan Device Initialized.");
 
     VulkanSwapchain swapchain(vulkanInstance, device, surface);
+    PipelineCache pipelineCache(device);
+    PipelineLibrary pipelineLibrary(device, &pipelineCache);
     RenderPass* renderPass = nullptr;
     Pipeline* pipeline = nullptr;
 
     try {
+        swapchain.setPresentationPolicy(presentation.policy);
         swapchain.init();
         Logger::getInstance().log("Vulkan Swapchain Initialized.");
 
         // Create RenderPass
-        renderPass = new RenderPass(device, swapchain, swapchain.getSwapchainImageFormat());
+        renderPass = new RenderPass(device, swapchain, swapchain.getSwapchainImageFormat(), framesInFlightFor(presentation.policy));
         Logger::getInstance().log("RenderPass created.");
 
-        // Create Pipeline
-        pipeline = new Pipeline(device, swapchain, renderPass->getRenderPass());
-        pipeline->createGraphicsPipeline(swapchain.getSwapchainExtent());
+        // Load the pipeline cache before the first pipeline is compiled
+        pipelineCache.init();
+        pipelineLibrary.init();
+
+        // Create Pipeline; it compiles in the background while the first frames only clear
+        pipeline = new Pipeline(device, swapchain, renderPass->getRenderPass(), &pipelineCache, &pipelineLibrary);
+        pipeline->createGraphicsPipeline();
         Logger::getInstance().log("Graphics Pipeline Created.");
 
         // Enter the main application loop
-        mainLoop(window, device, swapchain, pipeline, renderPass);
+        mainLoop(window, device, swapchain, pipeline, renderPass, pipelineCache, pipelineLibrary, presentation, gridOptions);
     }
     catch (const std::exception& e) {
         Logger::getInstance().logError(std::string("Error during Vulkan initialization or execution: ") + e.what());
-        cleanup(window, device, swapchain, pipeline, renderPass);
+        cleanup(window, device, swapchain, pipelineCache, pipelineLibrary, pipeline, renderPass);
         return -1;
     }
 
     // Cleanup resources
-    cleanup(window, device, swapchain, pipeline, renderPass);
+    cleanup(window, device, swapchain, pipelineCache, pipelineLibrary, pipeline, renderPass);
+    if (TraceRecorder::getInstance().isEnabled()) {
+        TraceRecorder::getInstance().writeChromeTrace(TraceRecorder::getInstance().getOutputPath());
+    }
     Logger::getInstance().log("Application exited cleanly.");
     return 0;
 }
 
-void mainLoop(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, Pipeline* pipeline, RenderPass* renderPass) {
+// Unhooks the per-loop objects (profiler, job system, uploads, grid callbacks) from a
+// RenderPass once the GPU is idle. Declared after them, so it also runs first when an
+// exception unwinds the loop, before any of them is destroyed under a frame in flight.
+class RenderPassDetacher {
+public:
+    RenderPassDetacher(VulkanDevice& device, RenderPass& renderPass) : device(device), renderPass(renderPass) {}
+    ~RenderPassDetacher() { detach(); }
+
+    void detach() {
+        if (!attached) {
+            return;
+        }
+        attached = false;
+        vkDeviceWaitIdle(device.getDevice());
+        renderPass.setGpuProfiler(nullptr);
+        renderPass.setReadbackManager(nullptr);
+        renderPass.setPrePassCallback(nullptr);
+        renderPass.setDrawListCallbacks(nullptr, nullptr);
+        renderPass.setJobSystem(nullptr);
+        renderPass.setUploadManager(nullptr);
+    }
+
+private:
+    VulkanDevice& device;
+    RenderPass& renderPass;
+    bool attached = true;
+};
+
+// Reached from GLFW callbacks through the window user pointer.
+struct WindowState {
+    VulkanSwapchain* swapchain;
+    RenderPass* renderPass;
+    LatencyMonitor* latencyMonitor;
+};
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+    auto* state = static_cast<WindowState*>(glfwGetWindowUserPointer(window));
+    state->swapchain->setDesiredExtent(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    state->renderPass->requestSwapchainRecreate();
+}
+
+// F9 starts a CPU trace capture, or stops it and writes it out.
+void toggleTraceCapture() {
+    TraceRecorder& recorder = TraceRecorder::getInstance();
+    if (recorder.isEnabled()) {
+        recorder.setEnabled(false);
+        recorder.writeChromeTrace(recorder.getOutputPath());
+    } else {
+        recorder.clear();
+        recorder.setEnabled(true);
+        VG_LOG_INFO("CPU trace capture started; press F9 again to write ", recorder.getOutputPath());
+    }
+}
+
+// F10 cycles the presentation policy. Present mode and image count follow on the
+// next swapchain rebuild; frames in flight stay as chosen at startup.
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (action != GLFW_PRESS) {
+        return;
+    }
+    if (key == GLFW_KEY_F9) {
+        toggleTraceCapture();
+        return;
+    }
+    if (key != GLFW_KEY_F10) {
+        return;
+    }
+    auto* state = static_cast<WindowState*>(glfwGetWindowUserPointer(window));
+    PresentationPolicy policy = nextPresentationPolicy(state->swapchain->getPresentationPolicy());
+    state->swapchain->setPresentationPolicy(policy);
+    state->renderPass->requestSwapchainRecreate();
+    state->latencyMonitor->reset(presentationPolicyName(policy));
+    VG_LOG_INFO("Switching presentation policy to ", presentationPolicyName(policy));
+}
+
+void mainLoop(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, Pipeline* pipeline, RenderPass* renderPass,
+              PipelineCache& pipelineCache, PipelineLibrary& pipelineLibrary, const PresentationSettings& presentation,
+              const GridOptions& gridOptions) {
     Logger::getInstance().log("Entering main loop...");
+    FrameLimiter frameLimiter;
+    frameLimiter.setTargetFrameRate(presentation.frameRateLimit);
+    LatencyMonitor latencyMonitor;
+    latencyMonitor.reset(presentationPolicyName(presentation.policy));
+
+    FrameStats frameStats;
+    GpuProfiler gpuProfiler(device, renderPass->getFrameRing().getFramesInFlight());
+    gpuProfiler.init();
+    gpuProfiler.setFrameTimeCallback([&frameStats](double ms) { frameStats.record(FrameMetric::GpuTime, ms); });
+
+    // Records the draw list's secondaries in parallel.
+    JobSystem jobSystem;
+    jobSystem.init();
+
+    UploadManager uploadManager(device);
+    GridLodPyramid gridData(gridOptions.width, gridOptions.height, gridOptions.lodMode, GridDataStore::kDefaultTileSize,
+                            gridOptions.lod ? 16 : 1);
+    GridRenderer grid(device, *renderPass, uploadManager, &pipelineCache, &pipelineLibrary);
+
+    RenderPassDetacher detacher(device, *renderPass);
+    renderPass->setGpuProfiler(&gpuProfiler);
+    renderPass->setJobSystem(&jobSystem);
+    if (gridOptions.enabled()) {
+        attachDemoGrid(gridOptions, *renderPass, uploadManager, gridData, grid);
+    }
+
+    WindowState windowState{ &swapchain, renderPass, &latencyMonitor };
+    glfwSetWindowUserPointer(window, &windowState);
+    glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+    glfwSetKeyCallback(window, keyCallback);
+
+    LatencyMonitor::Clock::time_point lastPresent{};
+    uint64_t gridFrame = 0;
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-        renderPass->drawFrame(pipeline); // Use RenderPass's drawFrame method
+        VG_TRACE_SCOPE("frame");
+        {
+            VG_TRACE_SCOPE("frame limiter");
+            frameLimiter.wait();
+        }
+        auto frameStart = LatencyMonitor::Clock::now();
+        {
+            VG_TRACE_SCOPE("poll events");
+            glfwPollEvents();
+        }
+        auto inputTime = LatencyMonitor::Clock::now();
+
+        // Nothing can be presented while minimized; sleep until the window changes.
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        if (width == 0 || height == 0) {
+            glfwWaitEvents();
+            lastPresent = LatencyMonitor::Clock::time_point{};
+            continue;
+        }
+
+        if (gridOptions.enabled()) {
+            animateDemoGrid(gridData, uploadManager, grid, gridFrame++);
+        }
+        bool presented = renderPass->drawFrame(pipeline);
+        auto frameEnd = LatencyMonitor::Clock::now();
+        frameStats.record(FrameMetric::CpuTime, std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+        if (presented) {
+            latencyMonitor.record(inputTime, frameEnd);
+            // Intervals spanning a minimized period say nothing about pacing.
+            if (lastPresent != LatencyMonitor::Clock::time_point{}) {
+                frameStats.record(FrameMetric::PresentInterval, std::chrono::duration<double, std::milli>(frameEnd - lastPresent).count());
+            }
+            lastPresent = frameEnd;
+        }
+        frameStats.frameCompleted();
     }
-    vkDeviceWaitIdle(device.getDevice());
+    glfwSetKeyCallback(window, nullptr);
+    glfwSetFramebufferSizeCallback(window, nullptr);
+    glfwSetWindowUserPointer(window, nullptr);
+    detacher.detach();
+    gpuProfiler.logStats();
+    gpuProfiler.cleanup();
+    grid.cleanup();
+    uploadManager.cleanup();
+    jobSystem.cleanup();
+    frameStats.logSummary();
     Logger::getInstance().log("Exiting main loop.");
 }
 
-void cleanup(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, Pipeline* pipeline, RenderPass* renderPass) {
+void cleanup(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchain, PipelineCache& pipelineCache,
+             PipelineLibrary& pipelineLibrary, Pipeline* pipeline, RenderPass* renderPass) {
     if (pipeline) {
         pipeline->cleanup();
         delete pipeline;
     }
+    // Finishes outstanding compiles, which still write to the pipeline cache
+    pipelineLibrary.cleanup();
+    // Written back here so the next start is warm
+    pipelineCache.cleanup();
     if (renderPass) {
         renderPass->cleanup();
         delete renderPass;
@@ -151,3 +382,252 @@ void cleanup(GLFWwindow* window, VulkanDevice& device, VulkanSwapchain& swapchai
     glfwDestroyWindow(window);
     glfwTerminate();
 }
+
+HeadlessOptions parseHeadlessOptions(int argc, char** argv) {
+    HeadlessOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--headless") {
+            options.enabled = true;
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            options.frameCount = static_cast<uint32_t>(std::stoul(arg.substr(9)));
+        } else if (arg.rfind("--size=", 0) == 0) {
+            const std::string size = arg.substr(7);
+            size_t separator = size.find('x');
+            if (separator != std::string::npos) {
+                options.extent.width = static_cast<uint32_t>(std::stoul(size.substr(0, separator)));
+                options.extent.height = static_cast<uint32_t>(std::stoul(size.substr(separator + 1)));
+            }
+        } else if (arg.rfind("--output=", 0) == 0) {
+            options.outputPath = arg.substr(9);
+        } else if (arg == "--readback") {
+            options.streamReadback = true;
+        }
+    }
+    return options;
+}
+
+GridOptions parseGridOptions(int argc, char** argv) {
+    GridOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--grid=", 0) == 0) {
+            const std::string size = arg.substr(7);
+            size_t separator = size.find('x');
+            if (separator != std::string::npos) {
+                options.width = static_cast<uint32_t>(std::stoul(size.substr(0, separator)));
+                options.height = static_cast<uint32_t>(std::stoul(size.substr(separator + 1)));
+            }
+        } else if (arg == "--no-grid-cull") {
+            options.culling = false;
+        } else if (arg == "--grid-lod") {
+            options.lod = true;
+        } else if (arg == "--grid-lod-max") {
+            options.lod = true;
+            options.lodMode = GridLodMode::Max;
+        }
+    }
+    return options;
+}
+
+static uint32_t demoCellColor(const GridDataStore& data, uint32_t x, uint32_t y) {
+    return packGridColor(static_cast<uint8_t>(x * 255ull / data.getWidth()), static_cast<uint8_t>(y * 255ull / data.getHeight()), 160);
+}
+
+// Cells one world unit apart, coloured by position so scrolling and culling are
+// easy to see; the grid is uploaded and drawn as the pass's dynamic content.
+// Without --grid-lod the pyramid has a single level and is just the cell store.
+void attachDemoGrid(const GridOptions& options, RenderPass& renderPass, UploadManager& uploadManager, GridLodPyramid& pyramid,
+                    GridRenderer& grid) {
+    uploadManager.init();
+    renderPass.setUploadManager(&uploadManager);
+
+    GridDataStore& data = pyramid.getLevel(0);
+    for (uint32_t y = 0; y < data.getHeight(); y++) {
+        for (uint32_t x = 0; x < data.getWidth(); x++) {
+            data.setCellColor(x, y, demoCellColor(data, x, y));
+        }
+    }
+    grid.init(pyramid.getTotalCellCount());
+    pyramid.flush(uploadManager, grid.getInstanceStorage());
+    grid.setInstanceCount(data.getCellCount());
+    grid.setLodPyramid(options.lod ? &pyramid : nullptr);
+
+    // Fit the whole grid vertically.
+    GridView view;
+    view.centerX = options.width * 0.5f;
+    view.centerY = options.height * 0.5f;
+    view.viewHeight = options.height * 1.05f;
+    grid.setView(view);
+    grid.setCellSize(0.9f);
+    grid.setCullingEnabled(options.culling);
+
+    renderPass.setPrePassCallback([&grid](FrameContext& frame) { return grid.recordCulling(frame); });
+    renderPass.setDrawListCallbacks([&grid](FrameContext& frame) { return grid.prepareDraws(frame); },
+                                    [&grid](VkCommandBuffer commandBuffer, size_t begin, size_t end) {
+                                        grid.recordDraws(commandBuffer, begin, end);
+                                    });
+    VG_LOG_INFO("Drawing a ", options.width, "x", options.height, " grid");
+}
+
+// Sweeps a white column across the grid; only the tiles it touches are uploaded.
+// The upload manager is the pass's, so these small copies are recorded at the head
+// of the next frame, after the earlier frames' draws and culling on the same queue.
+void animateDemoGrid(GridLodPyramid& pyramid, UploadManager& uploadManager, const GridRenderer& grid, uint64_t frame) {
+    GridDataStore& data = pyramid.getLevel(0);
+    uint32_t column = static_cast<uint32_t>(frame % data.getWidth());
+    uint32_t previous = (column + data.getWidth() - 1) % data.getWidth();
+    for (uint32_t y = 0; y < data.getHeight(); y++) {
+        data.setCellColor(previous, y, demoCellColor(data, previous, y));
+        data.setCellColor(column, y, packGridColor(255, 255, 255));
+    }
+    pyramid.flush(uploadManager, grid.getInstanceStorage());
+}
+
+// Binary PPM from tightly packed 8-bit RGBA/BGRA pixels; alpha is dropped.
+static bool writePPM(const std::string& path, const std::vector<uint8_t>& pixels, VkExtent2D extent, VkFormat format) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    bool bgr = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+    std::vector<uint8_t> row(static_cast<size_t>(extent.width) * 3);
+    for (uint32_t y = 0; y < extent.height; y++) {
+        const uint8_t* src = pixels.data() + static_cast<size_t>(y) * extent.width * 4;
+        for (uint32_t x = 0; x < extent.width; x++) {
+            row[x * 3 + 0] = src[x * 4 + (bgr ? 2 : 0)];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + (bgr ? 0 : 2)];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+int runHeadless(const HeadlessOptions& options, const PresentationSettings& presentation, const GridOptions& gridOptions) {
+    Logger::getInstance().log("Running headless: " + std::to_string(options.frameCount) + " frames at " +
+                              std::to_string(options.extent.width) + "x" + std::to_string(options.extent.height));
+
+    VulkanInstance vulkanInstance;
+    vulkanInstance.headless = true;
+    VulkanDevice device(vulkanInstance);
+    int exitCode = 0;
+
+    try {
+        vulkanInstance.init();
+        device.init(VK_NULL_HANDLE);
+
+        uint32_t framesInFlight = framesInFlightFor(presentation.policy);
+        OffscreenTarget target(device, options.extent, VK_FORMAT_R8G8B8A8_UNORM, framesInFlight);
+        target.init();
+
+        PipelineCache pipelineCache(device);
+        PipelineLibrary pipelineLibrary(device, &pipelineCache);
+        RenderPass renderPass(device, target, target.getImageFormat(), framesInFlight);
+        pipelineCache.init();
+        pipelineLibrary.init();
+
+        Pipeline pipeline(device, target, renderPass.getRenderPass(), &pipelineCache, &pipelineLibrary);
+        pipeline.createGraphicsPipeline();
+
+        // Stream every frame back and checksum it (FNV-1a) to exercise capture throughput.
+        ReadbackManager readback(device, framesInFlight + 2);
+        uint64_t checksum = 14695981039346656037ull;
+        uint64_t readbackBytes = 0;
+        if (options.streamReadback) {
+            readback.init();
+            readback.setCallback([&checksum, &readbackBytes](const ReadbackFrame& frame) {
+                const uint8_t* bytes = static_cast<const uint8_t*>(frame.data);
+                for (VkDeviceSize i = 0; i < frame.size; i++) {
+                    checksum = (checksum ^ bytes[i]) * 1099511628211ull;
+                }
+                readbackBytes += frame.size;
+            });
+        }
+
+        // frameCompleted() is never called, so the whole run stays in one window for the final summary.
+        FrameStats frameStats;
+        GpuProfiler gpuProfiler(device, framesInFlight);
+        gpuProfiler.init();
+        gpuProfiler.setFrameTimeCallback([&frameStats](double ms) { frameStats.record(FrameMetric::GpuTime, ms); });
+
+        JobSystem jobSystem;
+        jobSystem.init();
+
+        UploadManager uploadManager(device);
+        GridLodPyramid gridData(gridOptions.width, gridOptions.height, gridOptions.lodMode, GridDataStore::kDefaultTileSize,
+                                gridOptions.lod ? 16 : 1);
+        GridRenderer grid(device, renderPass, uploadManager, &pipelineCache, &pipelineLibrary);
+
+        RenderPassDetacher detacher(device, renderPass);
+        if (options.streamReadback) {
+            renderPass.setReadbackManager(&readback);
+        }
+        renderPass.setGpuProfiler(&gpuProfiler);
+        renderPass.setJobSystem(&jobSystem);
+        if (gridOptions.enabled()) {
+            attachDemoGrid(gridOptions, renderPass, uploadManager, gridData, grid);
+        }
+        // Every frame of a headless run counts, so none may be drawn with pipelines missing.
+        pipelineLibrary.waitIdle();
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < options.frameCount; frame++) {
+            auto frameStart = std::chrono::steady_clock::now();
+            if (gridOptions.enabled()) {
+                animateDemoGrid(gridData, uploadManager, grid, frame);
+            }
+            renderPass.drawFrame(&pipeline);
+            frameStats.record(FrameMetric::CpuTime, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+        renderPass.getFrameRing().waitIdle();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Logger::getInstance().log("Rendered " + std::to_string(options.frameCount) + " frames in " + std::to_string(seconds) + " s");
+        detacher.detach();
+        gpuProfiler.logStats();
+        gpuProfiler.cleanup();
+        frameStats.logSummary();
+
+        if (options.streamReadback) {
+            readback.poll(UINT64_MAX);
+            Logger::getInstance().log("Readback: " + std::to_string(readback.getDeliveredCount()) + " frames, " +
+                                      std::to_string(readback.getDroppedCount()) + " dropped, " +
+                                      std::to_string(readbackBytes / (1024.0 * 1024.0) / seconds) + " MB/s, checksum " +
+                                      std::to_string(checksum));
+            readback.cleanup();
+        }
+
+        if (!options.outputPath.empty() && target.hasPresentedImage()) {
+            std::vector<uint8_t> pixels;
+            target.readImage(target.getLatestImageIndex(), pixels);
+            if (writePPM(options.outputPath, pixels, target.getExtent(), target.getImageFormat())) {
+                Logger::getInstance().log("Wrote last frame to " + options.outputPath);
+            } else {
+                Logger::getInstance().logError("Failed to write " + options.outputPath);
+                exitCode = -1;
+            }
+        }
+
+        grid.cleanup();
+        uploadManager.cleanup();
+        jobSystem.cleanup();
+        pipeline.cleanup();
+        pipelineLibrary.cleanup();
+        pipelineCache.cleanup();
+        renderPass.cleanup();
+        target.cleanup();
+    }
+    catch (const std::exception& e) {
+        Logger::getInstance().logError(std::string("Error during headless rendering: ") + e.what());
+        exitCode = -1;
+    }
+
+    device.cleanup();
+    vulkanInstance.cleanup();
+    if (TraceRecorder::getInstance().isEnabled()) {
+        TraceRecorder::getInstance().writeChromeTrace(TraceRecorder::getInstance().getOutputPath());
+    }
+    Logger::getInstance().log(exitCode == 0 ? "Headless run finished." : "Headless run failed.");
+    return exitCode;
+}